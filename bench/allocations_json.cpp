@@ -0,0 +1,107 @@
+// Allocations par réponse de POST /books : document nlohmann::json puis dump(), comme
+// l'ancien livreToJson, contre JsonWriter, comme ecrireLivre. Chaque appel à
+// operator new est compté pendant la sérialisation de la même réponse, répétée.
+//
+//   cmake -DBUILD_BENCHMARKS=ON ... && ./bench_allocations_json [reponses]
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "JsonWriter.h"
+
+using crowjourney::JsonWriter;
+
+namespace {
+    std::atomic<std::size_t> allocations{ 0 };
+
+    // Champs d'un Livre, sans les chaînes internées du catalogue
+    struct LivreMesure {
+        std::string titre;
+        std::string auteur;
+        int annee;
+        std::string genre;
+        int id;
+    };
+
+    std::string reponseNlohmann(const LivreMesure& livre) {
+        nlohmann::json corps = {
+            {"id", livre.id},
+            {"titre", livre.titre},
+            {"auteur", livre.auteur},
+            {"annee", livre.annee},
+            {"genre", livre.genre}
+        };
+        corps["message"] = "Livre ajouté avec succès";
+        return corps.dump();
+    }
+
+    std::string reponseJsonWriter(const LivreMesure& livre) {
+        JsonWriter sortie;
+        sortie.debutObjet()
+            .champ("id", livre.id)
+            .champ("titre", livre.titre)
+            .champ("auteur", livre.auteur)
+            .champ("annee", livre.annee)
+            .champ("genre", livre.genre)
+            .champ("message", "Livre ajouté avec succès")
+            .finObjet();
+        return sortie.prendre();
+    }
+
+    // Allocations moyennes par réponse ; chaque corps est vérifié contre la référence
+    template <typename F>
+    double compter(long reponses, const std::string& reference, F&& serialiser) {
+        std::size_t total = 0;
+        for (long i = 0; i < reponses; ++i) {
+            const std::size_t avant = allocations.load(std::memory_order_relaxed);
+            std::string corps = serialiser();
+            total += allocations.load(std::memory_order_relaxed) - avant;
+            if (nlohmann::json::parse(corps) != nlohmann::json::parse(reference)) {
+                std::fprintf(stderr, "corps différent de la référence: %s\n", corps.c_str());
+                std::exit(1);
+            }
+        }
+        return static_cast<double>(total) / static_cast<double>(reponses);
+    }
+}
+
+void* operator new(std::size_t taille) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(taille ? taille : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    const long reponses = argc > 1 ? std::atol(argv[1]) : 1000;
+    if (reponses <= 0) {
+        std::fprintf(stderr, "usage: %s [reponses]\n", argv[0]);
+        return 2;
+    }
+
+    // Titre et auteur au-delà de la petite chaîne de la bibliothèque standard
+    const LivreMesure livre{ "Les Misérables, tome premier : Fantine", "Victor Hugo (1802-1885)",
+        1862, "Roman historique", 4242 };
+    const std::string reference = reponseNlohmann(livre);
+
+    const double par_nlohmann = compter(reponses, reference, [&] { return reponseNlohmann(livre); });
+    const double par_writer = compter(reponses, reference, [&] { return reponseJsonWriter(livre); });
+
+    std::printf("%ld réponses POST /books (%zu octets)\n", reponses, reference.size());
+    std::printf("  nlohmann::json + dump() : %6.1f allocations/réponse\n", par_nlohmann);
+    std::printf("  JsonWriter              : %6.1f allocations/réponse\n", par_writer);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Microbenchmark de la vérification des jetons : chemin rapide (JetonHS256::verifier)
+// contre le vérificateur générique de jwt-cpp (jwt::decode puis verify), configuré
+// comme celui de JWTAuthMiddleware.
+//
+//   cmake -DBUILD_BENCHMARKS=ON ... && ./bench_jeton_hs256 [iterations]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <jwt-cpp/jwt.h>
+#include "JetonHS256.h"
+#include "JsonWriter.h"
+
+using crowjourney::JetonHS256;
+using crowjourney::JsonWriter;
+
+namespace {
+    const std::string SECRET = "secret_de_mesure_suffisamment_long_pour_hs256";
+    const std::string EMETTEUR = "crowjourney";
+
+    // Empêche le compilateur d'écarter un résultat inutilisé
+    volatile std::uint64_t puits = 0;
+
+    // Durée moyenne d'un appel de f, en nanosecondes
+    template <typename F>
+    double mesurer(long iterations, F&& f) {
+        for (long i = 0; i < iterations / 10; ++i) {
+            f(); // Échauffement : caches, contextes HMAC des threads
+        }
+        const auto debut = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; ++i) {
+            f();
+        }
+        const auto fin = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(fin - debut).count() / static_cast<double>(iterations);
+    }
+}
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    // Jeton de la forme émise par JWTAuthMiddleware::generateToken
+    const std::int64_t maintenant = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    JsonWriter claims(256);
+    claims.debutObjet()
+        .champ("iss", EMETTEUR)
+        .champ("iat", maintenant)
+        .champ("exp", maintenant + 3600)
+        .champ("sub", "42")
+        .champ("role", "user")
+        .champ("email", "lecteur@example.org")
+        .champ("nom", "Lecteur")
+        .finObjet();
+
+    const JetonHS256 rapide(SECRET, EMETTEUR);
+    const std::string jeton = rapide.signer(claims.prendre());
+
+    const auto verificateur = jwt::verify()
+        .allow_algorithm(jwt::algorithm::hs256{ SECRET })
+        .with_issuer(EMETTEUR);
+
+    // Les deux chemins doivent accepter le jeton, sinon la comparaison n'a pas de sens
+    JetonHS256::Claims lus;
+    if (rapide.verifier(jeton, maintenant, lus).statut != JetonHS256::Statut::Valide) {
+        std::fprintf(stderr, "JetonHS256 refuse le jeton de mesure\n");
+        return 1;
+    }
+    try {
+        verificateur.verify(jwt::decode(jeton));
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "jwt-cpp refuse le jeton de mesure: %s\n", e.what());
+        return 1;
+    }
+
+    const double ns_rapide = mesurer(iterations, [&] {
+        JetonHS256::Claims c;
+        puits = puits + static_cast<std::uint64_t>(rapide.verifier(jeton, maintenant, c).statut) + c.sub.size();
+    });
+    const double ns_generique = mesurer(iterations, [&] {
+        auto decoded = jwt::decode(jeton);
+        verificateur.verify(decoded);
+        puits = puits + decoded.get_payload_claim("sub").as_string().size();
+    });
+
+    std::printf("jeton de %zu octets, %ld itérations\n", jeton.size(), iterations);
+    std::printf("  JetonHS256::verifier      : %8.0f ns/jeton\n", ns_rapide);
+    std::printf("  jwt::decode + verify      : %8.0f ns/jeton\n", ns_generique);
+    std::printf("  rapport                   : %8.1fx\n", ns_generique / ns_rapide);
+    return 0;
+}
@@ -10,7 +10,7 @@ function App() {
     const [activeSection, setActiveSection] = useState('books');
 
     // Utiliser un alias pour le "loading" d'authentification
-    const { user, isAuthenticated, loading: authLoading, token, logout } = useAuth();
+    const { user, isAuthenticated, loading: authLoading, logout } = useAuth();
 
     // État pour stocker les livres
     const [books, setBooks] = useState([]);
@@ -29,18 +29,9 @@ function App() {
         setDataLoading(true);
 
         try {
-
-            // Assurez-vous que le token est disponible et correctement formaté
-            console.log("Token utilisé pour la requête:", token);
-
-            // Ajout du token d'authentification si disponible
-            const headers = {};
-            if (token) {
-                headers['Authorization'] = `Bearer ${token}`;
-            }
-
+            // Le cookie de session est envoyé par le navigateur
             const response = await fetch(`${API_URL}/books`, {
-                headers
+                credentials: 'include'
             });
 
             console.log("Statut de la réponse:", response.status);
@@ -72,17 +63,10 @@ function App() {
         console.log("JSON envoyé:", JSON.stringify(bookData));
 
         try {
-            // Ajout du token d'authentification si disponible
-            const headers = {
-                'Content-Type': 'application/json'
-            };
-            if (token) {
-                headers['Authorization'] = `Bearer ${token}`;
-            }
-
             const response = await fetch(`${API_URL}/books`, {
                 method: 'POST',
-                headers,
+                headers: { 'Content-Type': 'application/json' },
+                credentials: 'include',
                 body: JSON.stringify(bookData)
             });
 
@@ -119,15 +103,9 @@ function App() {
         console.log("Suppression du livre avec l'ID:", bookId);
         console.log(API_URL + "/books/" + bookId);
         try {
-            // Ajout du token d'authentification si disponible
-            const headers = {};
-            if (token) {
-                headers['Authorization'] = `Bearer ${token}`;
-            }
-
             const response = await fetch(`${API_URL}/books/${bookId}`, {
                 method: 'DELETE',
-                headers
+                credentials: 'include'
             });
 
             if (!response.ok) {
@@ -8,29 +8,18 @@ export const useAuth = () => useContext(AuthContext);
 
 export const AuthProvider = ({ children }) => {
   const [user, setUser] = useState(null);
-  const [token, setToken] = useState(localStorage.getItem('token'));
   const [loading, setLoading] = useState(true);
   
   // URL de base de l'API
   const API_URL = 'http://localhost:8080';
 
-  // Vérifier le token au chargement
-    // Vérifier le token au chargement
+    // Vérifier la session au chargement : le cookie HttpOnly n'est pas lisible ici,
+    // seule une route protégée dit s'il est présent et valide
     useEffect(() => {
-        const verifyToken = async () => {
-            if (!token) {
-                setLoading(false);
-                return;
-            }
-
+        const verifySession = async () => {
             try {
-                console.log("Vérification du token:", token);
-
-                // Appel à une route protégée pour vérifier si le token est valide
                 const response = await fetch(`${API_URL}/protected`, {
-                    headers: {
-                        'Authorization': `Bearer ${token}`
-                    }
+                    credentials: 'include'
                 });
 
                 console.log("Statut de la réponse:", response.status);
@@ -47,32 +36,32 @@ export const AuthProvider = ({ children }) => {
                         nom: data.nom || "Utilisateur"  // Ajoutez le nom si disponible
                     });
                 } else {
-                    console.error("Échec de la vérification du token:", await response.text());
-                    // Ne pas se déconnecter immédiatement pour les erreurs 401
-                    // Particulièrement si vous venez juste de vous connecter
+                    // 401 : pas de session ouverte, l'utilisateur reste déconnecté
                     if (response.status !== 401) {
-                        logout();
+                        console.error("Échec de la vérification de la session:", await response.text());
                     }
                 }
             } catch (error) {
-                console.error("Erreur lors de la vérification du token:", error);
+                console.error("Erreur lors de la vérification de la session:", error);
                 // Ne pas se déconnecter en cas d'erreur réseau
             } finally {
                 setLoading(false);
             }
         };
 
-        verifyToken();
-    }, [token]);
+        verifySession();
+    }, []);
 
 
   // Fonction de login
-    // Dans AuthContext.jsx, assurez-vous que le token est correctement stocké
+    // Le serveur pose le cookie de session ; credentials: 'include' est nécessaire pour
+    // que le navigateur l'accepte sur cette réponse cross-origin
     const login = async (email, password) => {
         try {
             const response = await fetch(`${API_URL}/login`, {
                 method: 'POST',
                 headers: { 'Content-Type': 'application/json' },
+                credentials: 'include',
                 body: JSON.stringify({ email, password })
             });
 
@@ -82,13 +71,6 @@ export const AuthProvider = ({ children }) => {
             }
 
             const data = await response.json();
-
-            // Déboguer le token reçu
-            console.log("Token reçu:", data.token);
-
-            // Stocker le token dans localStorage
-            localStorage.setItem('token', data.token);
-            setToken(data.token);
             setUser(data.user);
 
             return { success: true };
@@ -97,11 +79,18 @@ export const AuthProvider = ({ children }) => {
         }
     };
 
-  // Fonction de déconnexion
-  const logout = () => {
-    localStorage.removeItem('token');
-    setToken(null);
-    setUser(null);
+  // Fonction de déconnexion : le serveur efface le cookie de session
+  const logout = async () => {
+    try {
+      await fetch(`${API_URL}/logout`, {
+        method: 'POST',
+        credentials: 'include'
+      });
+    } catch (error) {
+      console.error("Erreur lors de la déconnexion:", error);
+    } finally {
+      setUser(null);
+    }
   };
 
   // Fonction d'enregistrement
@@ -129,7 +118,6 @@ export const AuthProvider = ({ children }) => {
   // Valeur du contexte
   const value = {
     user,
-    token,
     loading,
     login,
     logout,
@@ -3,32 +3,27 @@
 const API_URL = 'http://localhost:8080';
 
 // Fonction utilitaire pour les requêtes API
+// Le jeton est dans un cookie HttpOnly posé par /login : le navigateur l'envoie
+// lui-même grâce à credentials: 'include', le script n'y a jamais accès.
 export const apiRequest = async (endpoint, options = {}) => {
-  const token = localStorage.getItem('token');
-  
-  // Ajouter l'en-tête d'autorisation si un token existe
   const headers = {
     'Content-Type': 'application/json',
     ...options.headers
   };
   
-  if (token) {
-    headers['Authorization'] = `Bearer ${token}`;
-  }
-  
   // Construire les options de la requête
   const requestOptions = {
     ...options,
-    headers
+    headers,
+    credentials: 'include'
   };
   
   try {
     const response = await fetch(`${API_URL}${endpoint}`, requestOptions);
     
-    // Si la réponse indique que le token est invalide (401)
+    // Si la réponse indique que la session est invalide ou expirée (401)
     if (response.status === 401) {
-      // Vider le localStorage et rafraîchir la page
-      localStorage.removeItem('token');
+      // Rafraîchir la page : l'application revient à l'écran de connexion
       window.location.reload();
       return;
     }
@@ -61,7 +56,35 @@ export const apiRequest = async (endpoint, options = {}) => {
 // Méthodes d'API spécifiques
 export const api = {
   // Livres
-  getBooks: () => apiRequest('/books'),
+  // Sans paramètre : catalogue complet (tableau).
+  // Avec { limit, cursor } : une page { livres, next_cursor } ; next_cursor vaut null sur la dernière.
+  // fields : liste des champs à renvoyer, ex. ['titre', 'auteur']
+  getBooks: ({ limit, cursor, fields } = {}) => {
+    const params = new URLSearchParams();
+    if (limit !== undefined) params.set('limit', limit);
+    if (cursor !== undefined && cursor !== null) params.set('cursor', cursor);
+    if (fields) params.set('fields', Array.isArray(fields) ? fields.join(',') : fields);
+    const query = params.toString();
+    return apiRequest(query ? `/books?${query}` : '/books');
+  },
+  // Parcourir tout le catalogue page par page
+  getAllBooksPaged: async function* ({ limit = 100, fields } = {}) {
+    let cursor = null;
+    do {
+      const page = await api.getBooks({ limit, cursor, fields });
+      yield page.livres;
+      cursor = page.next_cursor;
+    } while (cursor !== null);
+  },
+  // Nombre de livres filtrés : { total } ou, avec parDecennie, { total, par_decennie: [{ decennie, livres }] }
+  countBooks: (filtre = {}, parDecennie = false) =>
+    apiRequest(`/books/count?${new URLSearchParams(parDecennie ? { ...filtre, par: 'decennie' } : filtre)}`),
+  // Statistiques du catalogue : { total, auteurs, par_genre, par_decennie, top_auteurs }
+  getBookStats: (top) => apiRequest(top !== undefined ? `/books/stats?top=${top}` : '/books/stats'),
+  // Recherche plein texte, résultats classés par pertinence
+  searchBooks: (q, limit) => apiRequest(`/books/search?${new URLSearchParams(limit ? { q, limit } : { q })}`),
+  // Autocomplétion pendant la saisie : [{ texte, type, livres, distance }]
+  suggestBooks: (prefix, limit) => apiRequest(`/books/suggest?${new URLSearchParams(limit ? { prefix, limit } : { prefix })}`),
   addBook: (book) => apiRequest('/books', {
     method: 'POST',
     body: JSON.stringify(book)
@@ -75,6 +98,10 @@ export const api = {
     method: 'POST',
     body: JSON.stringify(credentials)
   }),
+  // Effacer le cookie de session (HttpOnly : seul le serveur peut le faire)
+  logout: () => apiRequest('/logout', {
+    method: 'POST'
+  }),
   register: (userData) => apiRequest('/users', {
     method: 'POST',
     body: JSON.stringify(userData)
@@ -1,41 +1,131 @@
 #pragma once
 #include <crow.h>
-#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Traces.h"
 
 namespace crowjourney_cors {
+
+    // Seul point d'application de CORS, placé en tête des middlewares de l'application.
+    //
+    // Les origines autorisées forment une liste blanche : CROWJOURNEY_CORS_ORIGINS (séparées
+    // par des virgules, "*" pour toutes) ou, par défaut, le serveur Vite du front React.
+    // Les valeurs des en-têtes sont calculées une fois, à la construction.
+    //
+    // Les préflights OPTIONS sont traités ici, avant le routage et l'authentification, avec
+    // un Access-Control-Max-Age qui permet au navigateur de les garder en cache. Les autres
+    // réponses reçoivent leurs en-têtes dans after_handle : un handler remplace la réponse
+    // entière, des en-têtes posés avant lui seraient perdus.
     class CORSMiddleware {
     public:
-        struct context {};
+        struct context {
+            std::string_view origine; // Origine autorisée de la requête (vide : pas d'en-têtes CORS)
+        };
 
-        // Traitement préliminaire des requêtes
-        void before_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
-            std::cout << "CORSMiddleware: traitement de " << req.url;
-            std::cout << " (méthode: " << (req.method == crow::HTTPMethod::Options ? "OPTIONS" : "AUTRE") << ")" << std::endl;
+        CORSMiddleware() : CORSMiddleware(originesConfigurees()) {}
 
-            // IMPORTANT: toujours ajouter les en-têtes CORS
-            res.set_header("Access-Control-Allow-Origin", "*");
-            res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, PATCH, OPTIONS");
-            res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        explicit CORSMiddleware(std::vector<std::string> origines, int max_age_secondes = 600)
+            : origines_(std::move(origines)),
+            methodes_("GET, POST, PUT, DELETE, PATCH, OPTIONS"),
+            entetes_("Content-Type, Authorization, If-None-Match, X-Ack-Mode"),
+            max_age_(std::to_string(max_age_secondes)) {
+            for (const auto& origine : origines_) {
+                toutes_ = toutes_ || origine == "*";
+            }
+        }
 
-            // Vérifier après avoir ajouté les en-têtes
-            std::cout << "En-tête CORS ajouté: " << res.get_header_value("Access-Control-Allow-Origin") << std::endl;
+        void before_handle(crow::request& req, crow::response& res, context& ctx) {
+            const std::string_view demandee = req.get_header_value("Origin");
+            ctx.origine = autorisee(demandee);
+            if (req.method != crow::HTTPMethod::Options) {
+                return;
+            }
 
-            // Pour les requêtes OPTIONS, terminer immédiatement
-            if (req.method == crow::HTTPMethod::Options) {
-                std::cout << "Requête OPTIONS détectée, terminaison rapide" << std::endl;
+            // Préflight : répondre sans routage ; une origine hors liste est refusée
+            TRACE_DEBUG("Préflight CORS", crowjourney::traces::champ("url", req.url),
+                crowjourney::traces::champ("origine", demandee));
+            varier(res);
+            if (!ctx.origine.empty()) {
                 res.code = 204;
-                res.end(); // CRUCIAL: terminer la réponse ici!
+                appliquer(res, ctx.origine);
+                res.set_header("Access-Control-Allow-Methods", methodes_);
+                res.set_header("Access-Control-Allow-Headers", entetes_);
+                res.set_header("Access-Control-Max-Age", max_age_);
+            }
+            else {
+                res.code = demandee.empty() ? 204 : 403;
+            }
+            res.end();
+        }
+
+        void after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+            varier(res);
+            if (!ctx.origine.empty()) {
+                appliquer(res, ctx.origine);
+            }
+        }
+
+    private:
+        std::vector<std::string> origines_;
+        bool toutes_ = false;
+        std::string methodes_;
+        std::string entetes_;
+        std::string max_age_;
+
+        // Origines de CROWJOURNEY_CORS_ORIGINS, ou celles du front en développement
+        static std::vector<std::string> originesConfigurees() {
+            const char* texte = std::getenv("CROWJOURNEY_CORS_ORIGINS");
+            std::string_view liste = texte ? texte : "http://localhost:5173,http://127.0.0.1:5173,http://localhost:4173";
+            std::vector<std::string> origines;
+            while (!liste.empty()) {
+                std::size_t virgule = liste.find(',');
+                std::string_view origine = liste.substr(0, virgule);
+                while (!origine.empty() && origine.front() == ' ') origine.remove_prefix(1);
+                while (!origine.empty() && origine.back() == ' ') origine.remove_suffix(1);
+                if (!origine.empty()) {
+                    origines.emplace_back(origine);
+                }
+                liste = virgule == std::string_view::npos ? std::string_view() : liste.substr(virgule + 1);
+            }
+            return origines;
+        }
+
+        // L'origine demandée si elle est dans la liste, vide sinon
+        std::string_view autorisee(std::string_view demandee) const {
+            if (demandee.empty()) {
+                return {};
+            }
+            if (toutes_) {
+                return demandee;
+            }
+            for (const auto& origine : origines_) {
+                if (origine == demandee) {
+                    return origine;
+                }
+            }
+            return {};
+        }
+
+        // Avec une liste explicite, toute réponse dépend de l'en-tête Origin, y compris
+        // celles sans en-têtes CORS (origine absente ou refusée) : sans Vary, un cache
+        // partagé pourrait servir l'une à la place de l'autre
+        void varier(crow::response& res) const {
+            if (!toutes_) {
+                res.set_header("Vary", "Origin");
             }
         }
 
-        void after_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
-            // Double vérification - s'assurer que les en-têtes CORS sont toujours présents
-            if (res.get_header_value("Access-Control-Allow-Origin").empty()) {
-                std::cout << "WARNING: En-tête CORS manquant après traitement! Réajout..." << std::endl;
+        void appliquer(crow::response& res, std::string_view origine) const {
+            if (toutes_) {
                 res.set_header("Access-Control-Allow-Origin", "*");
-                res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, PATCH, OPTIONS");
-                res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+                return;
             }
+            // Origine explicite : le navigateur peut envoyer les cookies
+            res.set_header("Access-Control-Allow-Origin", std::string(origine));
+            res.set_header("Access-Control-Allow-Credentials", "true");
         }
     };
 }
@@ -0,0 +1,106 @@
+#include "CacheJetons.h"
+#include "JetonHS256.h"
+#include <algorithm>
+#include <cstring>
+
+namespace crowjourney {
+
+    CacheJetons::CacheJetons(std::size_t capacite, std::size_t segments)
+        : segments_(std::max<std::size_t>(segments, 1)) {
+        capacite_segment_ = std::max<std::size_t>(capacite / segments_.size(), 1);
+    }
+
+    // Les octets 8 à 15 de la signature pour la table, les deux premiers pour le segment :
+    // les deux choix restent indépendants
+    std::size_t CacheJetons::HachageCle::operator()(const Cle& cle) const noexcept {
+        std::size_t valeur;
+        std::memcpy(&valeur, cle.data() + 8, sizeof(valeur));
+        return valeur;
+    }
+
+    bool CacheJetons::cleJeton(std::string_view jeton, Cle& cle) {
+        std::uint8_t signature[32];
+        if (!JetonHS256::signature(jeton, signature)) {
+            return false;
+        }
+        std::memcpy(cle.data(), signature, sizeof(signature));
+        return true;
+    }
+
+    CacheJetons::Segment& CacheJetons::segment(const Cle& cle) {
+        return segments_[(static_cast<std::size_t>(cle[0]) << 8 | cle[1]) % segments_.size()];
+    }
+
+    std::optional<CacheJetons::Identite> CacheJetons::chercher(std::string_view jeton) {
+        Cle cle;
+        if (!cleJeton(jeton, cle)) {
+            Segment& seg = segments_.front();
+            std::lock_guard<std::mutex> verrou(seg.mutex);
+            ++seg.echecs;
+            return std::nullopt;
+        }
+        Segment& seg = segment(cle);
+        std::lock_guard<std::mutex> verrou(seg.mutex);
+
+        auto it = seg.index.find(cle);
+        if (it == seg.index.end() || it->second->jeton != jeton) {
+            // Absent, ou signature reprise dans un autre jeton : l'entrée reste intacte
+            ++seg.echecs;
+            return std::nullopt;
+        }
+        if (it->second->expiration <= Horloge::now()) {
+            // Jeton expiré : la vérification complète le rejettera
+            seg.lru.erase(it->second);
+            seg.index.erase(it);
+            ++seg.echecs;
+            return std::nullopt;
+        }
+        seg.lru.splice(seg.lru.begin(), seg.lru, it->second);
+        ++seg.succes;
+        return it->second->identite;
+    }
+
+    void CacheJetons::ajouter(std::string_view jeton, Identite identite, Horloge::time_point expiration) {
+        Cle cle;
+        if (!cleJeton(jeton, cle)) {
+            return;
+        }
+        Segment& seg = segment(cle);
+        std::lock_guard<std::mutex> verrou(seg.mutex);
+
+        auto it = seg.index.find(cle);
+        if (it != seg.index.end()) {
+            // Vérifié en parallèle par un autre thread
+            seg.lru.splice(seg.lru.begin(), seg.lru, it->second);
+            return;
+        }
+        if (seg.lru.size() >= capacite_segment_) {
+            seg.index.erase(seg.lru.back().cle);
+            seg.lru.pop_back();
+            ++seg.evictions;
+        }
+        seg.lru.push_front(Entree{ cle, std::string(jeton), std::move(identite), expiration });
+        seg.index.emplace(cle, seg.lru.begin());
+    }
+
+    void CacheJetons::vider() {
+        for (auto& seg : segments_) {
+            std::lock_guard<std::mutex> verrou(seg.mutex);
+            seg.lru.clear();
+            seg.index.clear();
+        }
+    }
+
+    CacheJetons::Statistiques CacheJetons::statistiques() const {
+        Statistiques stats{ 0, capacite_segment_ * segments_.size(), 0, 0, 0 };
+        for (const auto& seg : segments_) {
+            std::lock_guard<std::mutex> verrou(seg.mutex);
+            stats.entrees += seg.lru.size();
+            stats.succes += seg.succes;
+            stats.echecs += seg.echecs;
+            stats.evictions += seg.evictions;
+        }
+        return stats;
+    }
+
+} // namespace crowjourney
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crowjourney {
+
+    // Cache des jetons JWT déjà vérifiés : un client réutilise le même jeton pendant des
+    // heures, il est inutile de le décoder et de recalculer son HMAC à chaque requête.
+    //
+    // La clé est la signature HMAC-SHA256 du jeton (32 octets décodés du dernier segment) :
+    // déjà un condensat de l'en-tête et des claims sous la clé du serveur, elle ne coûte
+    // qu'un décodage base64url, sans recalculer de SHA-256 à chaque requête. Un jeton forgé
+    // peut reprendre la signature d'un autre : l'entrée garde le jeton entier, comparé à
+    // chaque succès, et seuls des jetons vérifiés sont ajoutés.
+    // Chaque entrée expire à l'échéance (exp) du jeton. Le cache est découpé en segments
+    // indépendants, chacun LRU borné sous son propre mutex, pour que les threads de Crow
+    // ne se disputent pas un verrou unique.
+    class CacheJetons {
+    public:
+        using Horloge = std::chrono::system_clock;
+
+        // Claims extraits du jeton, recopiés dans le contexte du middleware
+        struct Identite {
+            std::string userId;
+            std::string role;
+        };
+
+        struct Statistiques {
+            std::size_t entrees;
+            std::size_t capacite;
+            std::uint64_t succes;
+            std::uint64_t echecs;
+            std::uint64_t evictions; // Entrées retirées par le LRU d'un segment plein
+
+            // Part des recherches servies par le cache (0 avant la première)
+            double tauxSucces() const {
+                std::uint64_t total = succes + echecs;
+                return total == 0 ? 0.0 : static_cast<double>(succes) / static_cast<double>(total);
+            }
+        };
+
+        explicit CacheJetons(std::size_t capacite = 10000, std::size_t segments = 16);
+
+        // Identité d'un jeton déjà vérifié et non expiré ; nullopt sinon (compté comme échec)
+        std::optional<Identite> chercher(std::string_view jeton);
+
+        // Mémoriser un jeton qui vient d'être vérifié, jusqu'à son expiration ; l'entrée
+        // la moins récemment utilisée du segment est évincée s'il est plein
+        void ajouter(std::string_view jeton, Identite identite, Horloge::time_point expiration);
+
+        void vider();
+
+        Statistiques statistiques() const;
+
+    private:
+        using Cle = std::array<std::uint8_t, 32>;
+
+        struct HachageCle {
+            std::size_t operator()(const Cle& cle) const noexcept;
+        };
+
+        struct Entree {
+            Cle cle;
+            std::string jeton;
+            Identite identite;
+            Horloge::time_point expiration;
+        };
+
+        struct Segment {
+            mutable std::mutex mutex;
+            std::list<Entree> lru; // Entrée la plus récemment utilisée en tête
+            std::unordered_map<Cle, std::list<Entree>::iterator, HachageCle> index;
+            std::uint64_t succes = 0;
+            std::uint64_t echecs = 0;
+            std::uint64_t evictions = 0;
+        };
+
+        std::size_t capacite_segment_;
+        std::vector<Segment> segments_; // Taille fixée à la construction
+
+        // false pour un jeton sans signature HS256 lisible (jamais mis en cache)
+        static bool cleJeton(std::string_view jeton, Cle& cle);
+        Segment& segment(const Cle& cle);
+    };
+
+} // namespace crowjourney
@@ -0,0 +1,101 @@
+#include "ChaineInternee.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace crowjourney {
+
+    namespace {
+        using Entree = ChaineInternee::Entree;
+
+        // Coût d'une valeur dans le pool : texte, entrée et nœud de l'index (estimé)
+        constexpr std::size_t SURCOUT_VALEUR = sizeof(Entree) + 64;
+
+        std::size_t limiteOctets() {
+            const char* texte = std::getenv("CROWJOURNEY_CHAINES_MAX_OCTETS");
+            std::size_t valeur = 0;
+            if (!texte || std::from_chars(texte, texte + std::strlen(texte), valeur).ec != std::errc() || valeur == 0) {
+                return 64u * 1024 * 1024;
+            }
+            return valeur;
+        }
+
+        // Les textes et leurs entrées sont alloués dans une arène monotone : un chargement
+        // en bloc ne fait qu'une allocation par tranche de l'arène, pas une par valeur
+        class PoolChaines {
+        public:
+            const Entree* chercher(std::string_view texte) const {
+                std::shared_lock<std::shared_mutex> verrou(mutex_);
+                auto it = index_.find(texte);
+                return it == index_.end() ? nullptr : it->second;
+            }
+
+            // borne : refuser (nullptr) une nouvelle valeur qui dépasserait limite_
+            const Entree* interner(std::string_view texte, bool borne) {
+                if (const Entree* entree = chercher(texte)) {
+                    return entree;
+                }
+                std::unique_lock<std::shared_mutex> verrou(mutex_);
+                auto it = index_.find(texte);
+                if (it != index_.end()) {
+                    return it->second; // Interné entre-temps par un autre thread
+                }
+                const std::size_t cout = texte.size() + SURCOUT_VALEUR;
+                if (borne && octets_ + cout > limite_) {
+                    return nullptr;
+                }
+                octets_ += cout;
+                char* copie = static_cast<char*>(arene_.allocate(texte.size(), 1));
+                std::memcpy(copie, texte.data(), texte.size());
+                auto* entree = new (arene_.allocate(sizeof(Entree), alignof(Entree)))
+                    Entree{ std::string_view(copie, texte.size()), static_cast<std::uint32_t>(index_.size() + 1) };
+                index_.emplace(entree->texte, entree);
+                return entree;
+            }
+
+        private:
+            mutable std::shared_mutex mutex_;
+            const std::size_t limite_ = limiteOctets();
+            std::size_t octets_ = 0;
+            std::pmr::monotonic_buffer_resource arene_{ 64 * 1024 };
+            std::pmr::unordered_map<std::string_view, const Entree*> index_{ &arene_ };
+        };
+
+        // Jamais détruit : des enregistrements peuvent encore pointer vers le pool
+        // pendant la destruction des autres objets statiques (sauvegarde à l'arrêt)
+        PoolChaines& pool() {
+            static PoolChaines* instance = new PoolChaines();
+            return *instance;
+        }
+    }
+
+    ChaineInternee::ChaineInternee(std::string_view texte)
+        : entree_(texte.empty() ? &VIDE : pool().interner(texte, false)) {
+    }
+
+    std::optional<ChaineInternee> ChaineInternee::chercher(std::string_view texte) {
+        if (texte.empty()) {
+            return ChaineInternee();
+        }
+        if (const Entree* entree = pool().chercher(texte)) {
+            return ChaineInternee(entree);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<ChaineInternee> ChaineInternee::admettre(std::string_view texte) {
+        if (texte.empty()) {
+            return ChaineInternee();
+        }
+        if (const Entree* entree = pool().interner(texte, true)) {
+            return ChaineInternee(entree);
+        }
+        return std::nullopt;
+    }
+
+} // namespace crowjourney
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace crowjourney {
+
+    // Chaîne internée : les valeurs qui se répètent d'un enregistrement à l'autre
+    // (auteur, genre, rôle) ne sont stockées qu'une fois, dans l'arène d'un pool global,
+    // et chaque enregistrement n'en garde qu'un pointeur. Copie, comparaison et hachage
+    // se font en temps constant ; chaque valeur distincte reçoit aussi un code entier
+    // dense (0 pour la chaîne vide), utilisable comme code de dictionnaire.
+    //
+    // Le pool ne libère jamais une valeur : sa taille suit le nombre de valeurs
+    // distinctes vues depuis le démarrage, non le nombre d'enregistrements. Les valeurs
+    // venues des clients passent donc par admettre, qui refuse d'en ajouter au-delà de
+    // CROWJOURNEY_CHAINES_MAX_OCTETS (64 Mio par défaut) ; le constructeur, utilisé au
+    // chargement des données déjà acceptées, n'est pas borné.
+    // Construire une chaîne internée est sûr depuis n'importe quel thread.
+    class ChaineInternee {
+    public:
+        struct Entree {
+            std::string_view texte;
+            std::uint32_t code;
+        };
+
+        constexpr ChaineInternee() noexcept : entree_(&VIDE) {}
+        ChaineInternee(std::string_view texte);
+        ChaineInternee(const char* texte) : ChaineInternee(std::string_view(texte)) {}
+        ChaineInternee(const std::string& texte) : ChaineInternee(std::string_view(texte)) {}
+
+        ChaineInternee& operator=(std::string_view texte) { return *this = ChaineInternee(texte); }
+        ChaineInternee& operator=(const char* texte) { return *this = ChaineInternee(texte); }
+        ChaineInternee& operator=(const std::string& texte) { return *this = ChaineInternee(texte); }
+
+        // Valeur déjà internée, sans l'ajouter au pool (nullopt si elle n'a jamais été vue)
+        static std::optional<ChaineInternee> chercher(std::string_view texte);
+
+        // Valeur internée si elle l'est déjà ou si le pool a encore de la place
+        // (nullopt si l'ajouter dépasserait la limite du pool)
+        static std::optional<ChaineInternee> admettre(std::string_view texte);
+
+        std::string_view vue() const noexcept { return entree_->texte; }
+        operator std::string_view() const noexcept { return entree_->texte; }
+        std::uint32_t code() const noexcept { return entree_->code; }
+        bool empty() const noexcept { return entree_->texte.empty(); }
+        std::size_t size() const noexcept { return entree_->texte.size(); }
+
+        friend bool operator==(ChaineInternee a, ChaineInternee b) noexcept { return a.entree_ == b.entree_; }
+        friend bool operator==(ChaineInternee a, std::string_view b) noexcept { return a.vue() == b; }
+        friend bool operator==(ChaineInternee a, const char* b) noexcept { return a.vue() == b; }
+        friend bool operator==(ChaineInternee a, const std::string& b) noexcept { return a.vue() == b; }
+
+    private:
+        static constexpr Entree VIDE{ {}, 0 };
+
+        explicit ChaineInternee(const Entree* entree) noexcept : entree_(entree) {}
+
+        const Entree* entree_;
+    };
+
+} // namespace crowjourney
+
+template <>
+struct std::hash<crowjourney::ChaineInternee> {
+    std::size_t operator()(crowjourney::ChaineInternee chaine) const noexcept {
+        return std::hash<std::uint32_t>{}(chaine.code());
+    }
+};
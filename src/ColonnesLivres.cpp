@@ -0,0 +1,217 @@
+#include "ColonnesLivres.h"
+#include "library.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <map>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CROWJOURNEY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace crowjourney {
+
+    namespace {
+        constexpr std::size_t LIGNES_PAR_BLOC = 64;
+
+        // Au-delà de cette étendue, l'histogramme par décennie passe par une table associative
+        constexpr std::int64_t DECENNIES_TABLE_MAX = 1 << 16;
+
+        std::int64_t decennie(std::int32_t annee) {
+            std::int64_t a = annee;
+            return (a >= 0 ? a / 10 : -((-a + 9) / 10)) * 10;
+        }
+    }
+
+    void ColonnesLivres::ajouter(const Livre& livre) {
+        if (livre.id < 0) {
+            return;
+        }
+        const std::size_t ligne = static_cast<std::size_t>(livre.id);
+        if (ligne >= annee_.size()) {
+            // Nouveau bloc : toutes ses lignes sont absentes jusqu'à leur attribution
+            const std::size_t lignes = (ligne / LIGNES_PAR_BLOC + 1) * LIGNES_PAR_BLOC;
+            annee_.resize(lignes, 0);
+            auteur_.resize(lignes, 0);
+            genre_.resize(lignes, 0);
+            absents_.resize(lignes / LIGNES_PAR_BLOC, ~std::uint64_t{ 0 });
+        }
+        annee_[ligne] = livre.annee;
+        auteur_[ligne] = livre.auteur.code();
+        genre_[ligne] = livre.genre.code();
+        absents_[ligne / LIGNES_PAR_BLOC] &= ~(std::uint64_t{ 1 } << (ligne % LIGNES_PAR_BLOC));
+
+        annee_plus_petite_ = std::min(annee_plus_petite_, livre.annee);
+        annee_plus_grande_ = std::max(annee_plus_grande_, livre.annee);
+    }
+
+    void ColonnesLivres::retirer(const Livre& livre) {
+        const std::size_t ligne = static_cast<std::size_t>(livre.id);
+        if (livre.id < 0 || ligne >= annee_.size()) {
+            return;
+        }
+        absents_[ligne / LIGNES_PAR_BLOC] |= std::uint64_t{ 1 } << (ligne % LIGNES_PAR_BLOC);
+    }
+
+    void ColonnesLivres::remplacer(const Livre* avant, const Livre* apres) {
+        if (apres) {
+            ajouter(*apres); // Écrase la ligne de l'ancien état
+        }
+        else if (avant) {
+            retirer(*avant);
+        }
+    }
+
+    void ColonnesLivres::vider() {
+        annee_.clear();
+        auteur_.clear();
+        genre_.clear();
+        absents_.clear();
+        annee_plus_petite_ = 0;
+        annee_plus_grande_ = 0;
+    }
+
+    bool ColonnesLivres::preparer(const FiltreLivres& filtre, Predicat& predicat) const {
+        predicat.annee_min = filtre.annee_min.value_or(std::numeric_limits<std::int32_t>::min());
+        predicat.annee_max = filtre.annee_max.value_or(std::numeric_limits<std::int32_t>::max());
+        predicat.par_auteur = filtre.auteur.has_value();
+        predicat.par_genre = filtre.genre.has_value();
+        predicat.auteur = 0;
+        predicat.genre = 0;
+        if (filtre.auteur) {
+            auto auteur = ChaineInternee::chercher(*filtre.auteur);
+            if (!auteur) return false;
+            predicat.auteur = auteur->code();
+        }
+        if (filtre.genre) {
+            auto genre = ChaineInternee::chercher(*filtre.genre);
+            if (!genre) return false;
+            predicat.genre = genre->code();
+        }
+        return predicat.annee_min <= predicat.annee_max;
+    }
+
+    std::uint64_t ColonnesLivres::evaluerBloc(std::size_t bloc, const Predicat& predicat) const {
+        const std::size_t debut = bloc * LIGNES_PAR_BLOC;
+        const std::int32_t* annees = annee_.data() + debut;
+        const std::uint32_t* auteurs = auteur_.data() + debut;
+        const std::uint32_t* genres = genre_.data() + debut;
+        std::uint64_t bits = 0;
+
+#if defined(__AVX2__)
+        // 8 lignes par itération : hors plage si min > annee ou annee > max
+        const __m256i min = _mm256_set1_epi32(predicat.annee_min);
+        const __m256i max = _mm256_set1_epi32(predicat.annee_max);
+        const __m256i auteur = _mm256_set1_epi32(static_cast<int>(predicat.auteur));
+        const __m256i genre = _mm256_set1_epi32(static_cast<int>(predicat.genre));
+        for (std::size_t i = 0; i < LIGNES_PAR_BLOC; i += 8) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(annees + i));
+            __m256i retenu = _mm256_andnot_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(min, a), _mm256_cmpgt_epi32(a, max)),
+                _mm256_set1_epi32(-1));
+            if (predicat.par_auteur) {
+                retenu = _mm256_and_si256(retenu, _mm256_cmpeq_epi32(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(auteurs + i)), auteur));
+            }
+            if (predicat.par_genre) {
+                retenu = _mm256_and_si256(retenu, _mm256_cmpeq_epi32(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(genres + i)), genre));
+            }
+            bits |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                _mm256_movemask_ps(_mm256_castsi256_ps(retenu)))) << i;
+        }
+#elif defined(CROWJOURNEY_SSE2)
+        // 4 lignes par itération
+        const __m128i min = _mm_set1_epi32(predicat.annee_min);
+        const __m128i max = _mm_set1_epi32(predicat.annee_max);
+        const __m128i auteur = _mm_set1_epi32(static_cast<int>(predicat.auteur));
+        const __m128i genre = _mm_set1_epi32(static_cast<int>(predicat.genre));
+        for (std::size_t i = 0; i < LIGNES_PAR_BLOC; i += 4) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(annees + i));
+            __m128i retenu = _mm_andnot_si128(
+                _mm_or_si128(_mm_cmpgt_epi32(min, a), _mm_cmpgt_epi32(a, max)),
+                _mm_set1_epi32(-1));
+            if (predicat.par_auteur) {
+                retenu = _mm_and_si128(retenu, _mm_cmpeq_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(auteurs + i)), auteur));
+            }
+            if (predicat.par_genre) {
+                retenu = _mm_and_si128(retenu, _mm_cmpeq_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(genres + i)), genre));
+            }
+            bits |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                _mm_movemask_ps(_mm_castsi128_ps(retenu)))) << i;
+        }
+#else
+        for (std::size_t i = 0; i < LIGNES_PAR_BLOC; ++i) {
+            const bool retenu = annees[i] >= predicat.annee_min && annees[i] <= predicat.annee_max
+                && (!predicat.par_auteur || auteurs[i] == predicat.auteur)
+                && (!predicat.par_genre || genres[i] == predicat.genre);
+            bits |= static_cast<std::uint64_t>(retenu) << i;
+        }
+#endif
+        return bits;
+    }
+
+    std::size_t ColonnesLivres::compter(const FiltreLivres& filtre) const {
+        Predicat predicat;
+        if (!preparer(filtre, predicat)) {
+            return 0;
+        }
+        std::size_t total = 0;
+        for (std::size_t bloc = 0; bloc < absents_.size(); ++bloc) {
+            const std::uint64_t presents = ~absents_[bloc];
+            if (presents != 0) {
+                total += static_cast<std::size_t>(std::popcount(evaluerBloc(bloc, predicat) & presents));
+            }
+        }
+        return total;
+    }
+
+    std::vector<std::pair<int, std::size_t>> ColonnesLivres::compterParDecennie(const FiltreLivres& filtre) const {
+        std::vector<std::pair<int, std::size_t>> resultat;
+        Predicat predicat;
+        if (!preparer(filtre, predicat)) {
+            return resultat;
+        }
+
+        // Histogramme dense si l'étendue des années le permet
+        const std::int64_t premiere = decennie(annee_plus_petite_);
+        const std::int64_t etendue = (decennie(annee_plus_grande_) - premiere) / 10 + 1;
+        std::vector<std::size_t> table(etendue <= DECENNIES_TABLE_MAX ? static_cast<std::size_t>(etendue) : 0, 0);
+        std::map<std::int64_t, std::size_t> associative;
+
+        for (std::size_t bloc = 0; bloc < absents_.size(); ++bloc) {
+            const std::uint64_t presents = ~absents_[bloc];
+            if (presents == 0) {
+                continue;
+            }
+            std::uint64_t bits = evaluerBloc(bloc, predicat) & presents;
+            while (bits != 0) {
+                const std::size_t ligne = bloc * LIGNES_PAR_BLOC + static_cast<std::size_t>(std::countr_zero(bits));
+                bits &= bits - 1;
+                const std::int64_t d = decennie(annee_[ligne]);
+                if (!table.empty()) {
+                    ++table[static_cast<std::size_t>((d - premiere) / 10)];
+                }
+                else {
+                    ++associative[d];
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            if (table[i] != 0) {
+                resultat.emplace_back(static_cast<int>(premiere + static_cast<std::int64_t>(i) * 10), table[i]);
+            }
+        }
+        for (const auto& [d, nombre] : associative) {
+            resultat.emplace_back(static_cast<int>(d), nombre);
+        }
+        return resultat;
+    }
+
+} // namespace crowjourney
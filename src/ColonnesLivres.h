@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "IndexLivres.h"
+
+struct Livre;
+
+namespace crowjourney {
+
+    // Copie en colonnes des champs analytiques du catalogue, pour les comptages
+    // (GET /books/count). La ligne d'un livre est son id :
+    //
+    //   annee_   : année (int32)
+    //   auteur_  : code de l'auteur interné (ChaineInternee::code)
+    //   genre_   : code du genre interné
+    //   absents_ : bitmap des lignes sans livre (supprimé ou id jamais attribué)
+    //
+    // Les colonnes sont allouées par blocs de 64 lignes, un mot du bitmap par bloc :
+    // les noyaux de filtrage (AVX2, SSE2, ou scalaires à défaut) évaluent un bloc
+    // entier sans traitement de fin, puis comptent les bits retenus.
+    //
+    // Comme IndexLivres, la structure n'est pas synchronisée : le gestionnaire la
+    // modifie et la lit sous son verrou d'index.
+    class ColonnesLivres {
+    public:
+        void ajouter(const Livre& livre);
+        void retirer(const Livre& livre);
+
+        // Remplacer l'état d'un livre (avant ou apres peut être nul)
+        void remplacer(const Livre* avant, const Livre* apres);
+
+        void vider();
+
+        // Nombre de livres satisfaisant le filtre
+        std::size_t compter(const FiltreLivres& filtre) const;
+
+        // Nombre de livres satisfaisant le filtre par décennie (première année de la
+        // décennie), par ordre croissant
+        std::vector<std::pair<int, std::size_t>> compterParDecennie(const FiltreLivres& filtre) const;
+
+    private:
+        // Critères du filtre traduits en codes ; faux si aucun livre ne peut correspondre
+        struct Predicat {
+            std::int32_t annee_min;
+            std::int32_t annee_max;
+            bool par_auteur;
+            std::uint32_t auteur;
+            bool par_genre;
+            std::uint32_t genre;
+        };
+        bool preparer(const FiltreLivres& filtre, Predicat& predicat) const;
+
+        // Bits des lignes du bloc satisfaisant le prédicat (hors bitmap des absents)
+        std::uint64_t evaluerBloc(std::size_t bloc, const Predicat& predicat) const;
+
+        std::vector<std::int32_t> annee_;
+        std::vector<std::uint32_t> auteur_;
+        std::vector<std::uint32_t> genre_;
+        std::vector<std::uint64_t> absents_;
+        int annee_plus_petite_ = 0; // Bornes des années vues (jamais resserrées)
+        int annee_plus_grande_ = 0;
+    };
+
+} // namespace crowjourney
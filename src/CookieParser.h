@@ -1,47 +1,61 @@
-// À ajouter dans un nouveau fichier src/CookieParser.h
 #pragma once
 #include <crow.h>
-#include <unordered_map>
-#include <string>
+#include <string_view>
 
 namespace crow {
+    // Lecture des cookies de la requête, à la demande
+    //
+    // before_handle ne fait que retenir la requête : l'en-tête Cookie n'est cherché qu'au
+    // premier get_cookie, puis parcouru sans copie à chaque appel (quelques cookies au plus).
+    // Les vues renvoyées pointent dans l'en-tête et restent valides le temps de la requête.
     class CookieParser {
     public:
         struct context {
-            std::unordered_map<std::string, std::string> cookies;
-        };
+            // Valeur du cookie `nom` (guillemets retirés), vide s'il est absent
+            std::string_view get_cookie(std::string_view nom) const {
+                if (!lu_) {
+                    entete_ = requete_ ? std::string_view(requete_->get_header_value("Cookie")) : std::string_view();
+                    lu_ = true;
+                }
+
+                std::string_view reste = entete_;
+                while (!reste.empty()) {
+                    std::size_t fin = reste.find(';');
+                    std::string_view paire = reste.substr(0, fin);
+                    reste = fin == std::string_view::npos ? std::string_view() : reste.substr(fin + 1);
 
-        void before_handle(request& req, response& res, context& ctx) {
-            // Analyser les cookies depuis l'en-tête de la requête
-            std::string cookie_header = req.get_header_value("Cookie");
-            if (!cookie_header.empty()) {
-                size_t pos = 0;
-                while (pos < cookie_header.length()) {
-                    size_t end = cookie_header.find(';', pos);
-                    if (end == std::string::npos)
-                        end = cookie_header.length();
-                    
-                    size_t equal = cookie_header.find('=', pos);
-                    if (equal < end) {
-                        std::string key = cookie_header.substr(pos, equal - pos);
-                        std::string value = cookie_header.substr(equal + 1, end - equal - 1);
-                        
-                        // Supprimer les espaces en début et fin
-                        key.erase(0, key.find_first_not_of(" \t"));
-                        key.erase(key.find_last_not_of(" \t") + 1);
-                        value.erase(0, value.find_first_not_of(" \t"));
-                        value.erase(value.find_last_not_of(" \t") + 1);
-                        
-                        ctx.cookies[key] = value;
+                    std::size_t egal = paire.find('=');
+                    if (egal == std::string_view::npos || rogner(paire.substr(0, egal)) != nom) {
+                        continue;
                     }
-                    
-                    pos = end + 1;
+                    std::string_view valeur = rogner(paire.substr(egal + 1));
+                    if (valeur.size() >= 2 && valeur.front() == '"' && valeur.back() == '"') {
+                        valeur = valeur.substr(1, valeur.size() - 2);
+                    }
+                    return valeur;
                 }
+                return {};
+            }
+
+        private:
+            friend class CookieParser;
+
+            const request* requete_ = nullptr;
+            mutable std::string_view entete_;
+            mutable bool lu_ = false;
+
+            static std::string_view rogner(std::string_view texte) {
+                while (!texte.empty() && (texte.front() == ' ' || texte.front() == '\t')) texte.remove_prefix(1);
+                while (!texte.empty() && (texte.back() == ' ' || texte.back() == '\t')) texte.remove_suffix(1);
+                return texte;
             }
+        };
+
+        void before_handle(request& req, response& /*res*/, context& ctx) {
+            ctx.requete_ = &req;
         }
 
-        void after_handle(request&, response& res, context& ctx) {
-            // Facultatif : Ajouter les cookies de réponse
+        void after_handle(request& /*req*/, response& /*res*/, context& /*ctx*/) {
         }
     };
 }
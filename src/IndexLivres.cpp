@@ -0,0 +1,194 @@
+#include "IndexLivres.h"
+#include "library.h"
+#include <algorithm>
+
+namespace crowjourney {
+
+    namespace {
+        void insererId(std::vector<int>& ids, int id) {
+            // Les nouveaux livres ont l'id le plus grand : l'ajout se fait presque toujours en fin
+            if (ids.empty() || ids.back() < id) {
+                ids.push_back(id);
+                return;
+            }
+            auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+            if (pos == ids.end() || *pos != id) {
+                ids.insert(pos, id);
+            }
+        }
+
+        template <typename Index, typename Cle>
+        void retirerId(Index& index, const Cle& cle, int id) {
+            auto it = index.find(cle);
+            if (it == index.end()) {
+                return;
+            }
+            auto& ids = it->second;
+            auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+            if (pos != ids.end() && *pos == id) {
+                ids.erase(pos);
+            }
+            if (ids.empty()) {
+                index.erase(it);
+            }
+        }
+
+        bool parcourirListe(const std::vector<int>& ids, int apres, const std::function<bool(int)>& visiter) {
+            for (auto it = std::upper_bound(ids.begin(), ids.end(), apres); it != ids.end(); ++it) {
+                if (!visiter(*it)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Ids communs aux deux listes triées : la plus courte est parcourue, la position dans
+        // l'autre ne fait qu'avancer (recherche dichotomique depuis la position courante)
+        bool parcourirIntersection(const std::vector<int>& courte, const std::vector<int>& longue, int apres,
+            const std::function<bool(int)>& visiter) {
+            auto pos = longue.begin();
+            for (auto it = std::upper_bound(courte.begin(), courte.end(), apres); it != courte.end(); ++it) {
+                pos = std::lower_bound(pos, longue.end(), *it);
+                if (pos == longue.end()) {
+                    return true;
+                }
+                if (*pos == *it && !visiter(*it)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Fusion paresseuse des listes d'une plage d'années par id croissant : un tas de
+        // curseurs, un par année, chacun placé après apres. Seuls les ids effectivement
+        // visités sont lus (limit=10 coûte une dizaine de pas, pas un tri de la plage) ;
+        // un livre n'a qu'une année, les listes sont donc disjointes.
+        bool parcourirFusion(std::map<int, std::vector<int>>::const_iterator debut,
+            std::map<int, std::vector<int>>::const_iterator fin, int apres, const std::function<bool(int)>& visiter) {
+            using Curseur = std::pair<std::vector<int>::const_iterator, std::vector<int>::const_iterator>;
+            std::vector<Curseur> tas;
+            for (auto it = debut; it != fin; ++it) {
+                auto pos = std::upper_bound(it->second.begin(), it->second.end(), apres);
+                if (pos != it->second.end()) {
+                    tas.emplace_back(pos, it->second.end());
+                }
+            }
+            // Tas min sur l'id courant de chaque curseur
+            auto apresDans = [](const Curseur& a, const Curseur& b) { return *a.first > *b.first; };
+            std::make_heap(tas.begin(), tas.end(), apresDans);
+            while (!tas.empty()) {
+                std::pop_heap(tas.begin(), tas.end(), apresDans);
+                Curseur& curseur = tas.back();
+                if (!visiter(*curseur.first)) {
+                    return false;
+                }
+                if (++curseur.first == curseur.second) {
+                    tas.pop_back();
+                }
+                else {
+                    std::push_heap(tas.begin(), tas.end(), apresDans);
+                }
+            }
+            return true;
+        }
+    }
+
+    bool FiltreLivres::accepte(const Livre& livre) const {
+        return (!auteur || livre.auteur == *auteur)
+            && (!genre || livre.genre == *genre)
+            && (!annee_min || livre.annee >= *annee_min)
+            && (!annee_max || livre.annee <= *annee_max);
+    }
+
+    void IndexLivres::ajouter(const Livre& livre) {
+        insererId(par_auteur_[livre.auteur], livre.id);
+        insererId(par_genre_[livre.genre], livre.id);
+        insererId(par_annee_[livre.annee], livre.id);
+    }
+
+    void IndexLivres::retirer(const Livre& livre) {
+        retirerId(par_auteur_, livre.auteur, livre.id);
+        retirerId(par_genre_, livre.genre, livre.id);
+        retirerId(par_annee_, livre.annee, livre.id);
+    }
+
+    void IndexLivres::remplacer(const Livre* avant, const Livre* apres) {
+        if (avant && apres && avant->id == apres->id) {
+            // Seules les clés qui changent sont déplacées (une mise à jour du titre ne touche rien)
+            if (avant->auteur != apres->auteur) {
+                retirerId(par_auteur_, avant->auteur, avant->id);
+                insererId(par_auteur_[apres->auteur], apres->id);
+            }
+            if (avant->genre != apres->genre) {
+                retirerId(par_genre_, avant->genre, avant->id);
+                insererId(par_genre_[apres->genre], apres->id);
+            }
+            if (avant->annee != apres->annee) {
+                retirerId(par_annee_, avant->annee, avant->id);
+                insererId(par_annee_[apres->annee], apres->id);
+            }
+            return;
+        }
+        if (avant) {
+            retirer(*avant);
+        }
+        if (apres) {
+            ajouter(*apres);
+        }
+    }
+
+    void IndexLivres::vider() {
+        par_auteur_.clear();
+        par_genre_.clear();
+        par_annee_.clear();
+    }
+
+    void IndexLivres::parcourir(const FiltreLivres& filtre, int apres, const std::function<bool(int)>& visiter) const {
+        // Listes des critères d'égalité, la plus courte en premier
+        const std::vector<int>* listes[2] = { nullptr, nullptr };
+        std::size_t nombre = 0;
+        auto retenir = [&listes, &nombre](const auto& index, const std::optional<std::string>& cle) {
+            if (!cle) {
+                return true;
+            }
+            auto valeur = ChaineInternee::chercher(*cle);
+            auto it = valeur ? index.find(*valeur) : index.end();
+            if (it == index.end()) {
+                return false; // Aucun livre pour cette valeur
+            }
+            listes[nombre++] = &it->second;
+            return true;
+        };
+        if (!retenir(par_auteur_, filtre.auteur) || !retenir(par_genre_, filtre.genre)) {
+            return;
+        }
+        if (nombre == 2 && listes[1]->size() < listes[0]->size()) {
+            std::swap(listes[0], listes[1]);
+        }
+
+        if (filtre.annee_min || filtre.annee_max) {
+            if (filtre.annee_min && filtre.annee_max && *filtre.annee_min > *filtre.annee_max) {
+                return;
+            }
+            auto debut = filtre.annee_min ? par_annee_.lower_bound(*filtre.annee_min) : par_annee_.begin();
+            auto fin = filtre.annee_max ? par_annee_.upper_bound(*filtre.annee_max) : par_annee_.end();
+
+            std::size_t taille = 0;
+            for (auto it = debut; it != fin; ++it) {
+                taille += it->second.size();
+            }
+            if (nombre == 0 || taille < listes[0]->size()) {
+                parcourirFusion(debut, fin, apres, visiter);
+                return;
+            }
+        }
+
+        if (nombre == 2) {
+            parcourirIntersection(*listes[0], *listes[1], apres, visiter);
+        }
+        else if (nombre == 1) {
+            parcourirListe(*listes[0], apres, visiter);
+        }
+    }
+
+} // namespace crowjourney
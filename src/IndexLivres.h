@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ChaineInternee.h"
+
+struct Livre;
+
+namespace crowjourney {
+
+    // Critères de GET /books?auteur=&genre=&annee_min=&annee_max= (tous optionnels, combinés par ET)
+    struct FiltreLivres {
+        std::optional<std::string> auteur;
+        std::optional<std::string> genre;
+        std::optional<int> annee_min;
+        std::optional<int> annee_max;
+
+        bool actif() const { return auteur || genre || annee_min || annee_max; }
+        bool accepte(const Livre& livre) const;
+    };
+
+    // Index secondaires du catalogue : table de hachage sur l'auteur et le genre (internés),
+    // index ordonné sur l'année. Chaque entrée contient les ids triés par ordre croissant.
+    //
+    // Les index sont tenus à jour à chaque mutation et ne sont pas synchronisés :
+    // le gestionnaire les protège par un verrou partagé, qui couvre aussi la
+    // publication de la version du catalogue correspondante.
+    class IndexLivres {
+    public:
+        void ajouter(const Livre& livre);
+        void retirer(const Livre& livre);
+
+        // Remplacer l'état indexé d'un livre (avant ou apres peut être nul)
+        void remplacer(const Livre* avant, const Livre* apres);
+
+        void vider();
+
+        // Parcourir par id croissant les ids supérieurs à apres susceptibles de satisfaire
+        // le filtre, tant que visiter renvoie true. Auteur et genre ensemble : intersection
+        // de leurs listes. Plage d'années plus sélective : fusion paresseuse de ses listes.
+        // L'appelant vérifie les critères restants avec FiltreLivres::accepte.
+        void parcourir(const FiltreLivres& filtre, int apres, const std::function<bool(int)>& visiter) const;
+
+    private:
+        std::unordered_map<ChaineInternee, std::vector<int>> par_auteur_;
+        std::unordered_map<ChaineInternee, std::vector<int>> par_genre_;
+        std::map<int, std::vector<int>> par_annee_;
+    };
+
+} // namespace crowjourney
@@ -1,8 +1,7 @@
-#include <iostream>
 #include <crow.h>
 #include "library.h"
 #include "JWTAuthMiddleware.h"
-#include "CookieParser.h" 
+#include "Traces.h"
 #include <stdexcept>
 
 namespace crowjourney {
@@ -10,54 +9,106 @@ namespace crowjourney {
     // Constructeur
     JWTAuthMiddleware::JWTAuthMiddleware(const std::string& secret,
         const std::string& issuer,
-        int expiration_hours)
-        : secret_(secret), issuer_(issuer), expiration_hours_(expiration_hours) {
+        int expiration_hours,
+        const std::string& cookie_name)
+        : secret_(secret), issuer_(issuer), expiration_hours_(expiration_hours), cookie_name_(cookie_name),
+        jeton_(secret, issuer),
+        verificateur_(jwt::verify()
+            .allow_algorithm(jwt::algorithm::hs256{ secret })
+            .with_issuer(issuer)),
+        cache_(std::make_shared<CacheJetons>()) {
     }
 
     // Méthode appelée avant le traitement de la requête
-    void JWTAuthMiddleware::before_handle(crow::request& req, crow::response& res, context& ctx)
+    void JWTAuthMiddleware::authentifier(crow::request& req, crow::response& res, context& ctx,
+        PolitiqueAcces politique, const crow::CookieParser::context& cookies)
     {
-        //console log
-		std::cout << "JWTAuthMiddleware::before_handle - Traitement de la requête: " << req.url << std::endl;
+        TRACE_DEBUG("JWTAuthMiddleware: traitement de la requête", traces::champ("url", req.url));
 
         // Ne pas traiter les requêtes OPTIONS, laisser le middleware CORS s'en charger
         if (req.method == crow::HTTPMethod::Options) {
-            std::cout << "JWTAuthMiddleware: requête OPTIONS ignorée" << std::endl;
+            TRACE_DEBUG("JWTAuthMiddleware: requête OPTIONS ignorée");
             return;
         }
 
-        // Ignorer certaines routes sans authentification 
-        // (par exemple, login et création d'utilisateur)
-        if (req.url == "/login" ||
-            (req.url == "/users" && req.method == crow::HTTPMethod::POST)) {
+        // Politique déclarée avec la route : une route publique ne lit ni en-tête ni cookie
+        if (politique == ACCES_PUBLIC) {
             return;
         }
 
-        // Récupérer le token du header Authorization
-        std::string auth_header = req.get_header_value("Authorization");
-        if (auth_header.empty() || auth_header.substr(0, 7) != "Bearer ") {
-            res = unauthorized("Authentification requise");
+        // Récupérer le token du header Authorization, sinon du cookie de session
+        // (vues sur les en-têtes, sans copie ; les cookies ne sont lus qu'ici)
+        std::string_view auth_header = req.get_header_value("Authorization");
+        std::string_view token;
+        if (auth_header.substr(0, 7) == "Bearer ") {
+            token = auth_header.substr(7);
+        }
+        else if (!cookie_name_.empty()) {
+            token = cookies.get_cookie(cookie_name_);
+        }
+        if (token.empty()) {
+            refuser(res, 401, "Authentification requise");
             return;
         }
 
-        std::string token = auth_header.substr(7);
+        if (!identifier(token, ctx, res)) {
+            return;
+        }
+        ctx.roles = lireRole(ctx.role).value_or(RoleUser{});
+        if ((ctx.roles & politique) == 0) {
+            refuser(res, 403, "Accès non autorisé pour ce rôle");
+        }
+    }
+
+    bool JWTAuthMiddleware::identifier(std::string_view token, context& ctx, crow::response& res) {
+        metriques::Chrono chrono(metriques::Etape::VerificationJwt);
+
+        // Jeton déjà vérifié et non expiré : ni décodage ni HMAC
+        if (auto identite = cache_->chercher(token)) {
+            ctx.userId = std::move(identite->userId);
+            ctx.role = std::move(identite->role);
+            ctx.authenticated = true;
+            return true;
+        }
+
+        // Jetons émis par generateToken : vérification HS256 sans passer par jwt-cpp
+        const std::int64_t maintenant = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        JetonHS256::Claims claims;
+        JetonHS256::Resultat resultat = jeton_.verifier(token, maintenant, claims);
+        if (resultat.statut == JetonHS256::Statut::Valide) {
+            ctx.userId = std::move(claims.sub);
+            ctx.role = std::move(claims.role);
+            ctx.authenticated = true;
+            cache_->ajouter(token, { ctx.userId, ctx.role },
+                std::chrono::system_clock::time_point(std::chrono::seconds(claims.exp)));
+            return true;
+        }
+        if (resultat.statut == JetonHS256::Statut::Invalide) {
+            refuser(res, 401, std::string("Token invalide: ") + resultat.erreur);
+            return false;
+        }
+
+        // Autre forme de jeton : vérificateur générique
         try {
             // Vérifier et décoder le token
-            auto decoded = jwt::decode(token);
-            auto verifier = jwt::verify()
-                .allow_algorithm(jwt::algorithm::hs256{ secret_ })
-                .with_issuer(issuer_);
-
-            verifier.verify(decoded);
+            auto decoded = jwt::decode(std::string(token));
+            verificateur_.verify(decoded);
 
             // Extraire les claims du token
             ctx.userId = decoded.get_payload_claim("sub").as_string();
             ctx.role = decoded.get_payload_claim("role").as_string();
             ctx.authenticated = true;
 
+            // Un jeton sans échéance n'est pas mis en cache : il y resterait indéfiniment
+            if (decoded.has_expires_at()) {
+                cache_->ajouter(token, { ctx.userId, ctx.role }, decoded.get_expires_at());
+            }
+            return true;
         }
         catch (const std::exception& e) {
-            res = unauthorized("Token invalide: " + std::string(e.what()));
+            refuser(res, 401, "Token invalide: " + std::string(e.what()));
+            return false;
         }
     }
 
@@ -69,47 +120,45 @@ namespace crowjourney {
 
     // Générer un token JWT pour un utilisateur
     std::string JWTAuthMiddleware::generateToken(const User& user) {
-        auto now = std::chrono::system_clock::now();
-        auto expiration = now + std::chrono::hours(expiration_hours_);
-
-        return jwt::create()
-            .set_issuer(issuer_)
-            .set_issued_at(now)
-            .set_expires_at(expiration)
-            .set_subject(std::to_string(user.id))
-            .set_payload_claim("role", jwt::claim(user.role))
-            .set_payload_claim("email", jwt::claim(user.email))
-            .set_payload_claim("nom", jwt::claim(user.nom))
-            .sign(jwt::algorithm::hs256{ secret_ });
+        const std::int64_t maintenant = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        JsonWriter claims(256);
+        claims.debutObjet()
+            .champ("iss", issuer_)
+            .champ("iat", maintenant)
+            .champ("exp", maintenant + std::int64_t{ expiration_hours_ } * 3600)
+            .champ("sub", std::to_string(user.id))
+            .champ("role", nomRole(user.role))
+            .champ("email", user.email)
+            .champ("nom", user.nom)
+            .finObjet();
+        return jeton_.signer(claims.prendre());
     }
 
-    bool JWTAuthMiddleware::hasRole(const crow::request& req, const std::string& role) {
-        
-		// On ne peut pas utiliser get_context directement ici car c'est une méthode template
-        if (!req.middleware_context) {
-            return false;
-        }
-
-		// On suppose que le middleware_context contient notre contexte
-        try {
-            auto* ctx = static_cast<context*>(req.middleware_context);
-            return ctx && ctx->authenticated && ctx->role == role;
-        }
-        catch (...) {
-            return false; // Gestion d'erreur supplémentaire
+    std::string JWTAuthMiddleware::cookieJeton(std::string_view token) const {
+        if (cookie_name_.empty()) {
+            return {};
         }
+        // Illisible depuis JavaScript, envoyé seulement par le site du front, et expirant
+        // avec le jeton qu'il contient
+        std::string cookie;
+        cookie.reserve(cookie_name_.size() + token.size() + 80);
+        cookie.append(cookie_name_).append("=").append(token);
+        cookie.append("; Path=/; HttpOnly; Secure; SameSite=Strict; Max-Age=");
+        cookie.append(token.empty() ? "0" : std::to_string(std::int64_t{ expiration_hours_ } * 3600));
+        return cookie;
     }
 
-
-
-    // Créer une réponse "unauthorized"
-    crow::response JWTAuthMiddleware::unauthorized(const std::string& message) {
+    // Répondre tout de suite à la place du handler : sans end(), Crow poursuivrait
+    // jusqu'à la route et sa réponse remplacerait celle-ci
+    void JWTAuthMiddleware::refuser(crow::response& res, int code, const std::string& message) {
         crow::json::wvalue result;
         result["status"] = "error";
         result["message"] = message;
-        crow::response res(401, result);
+        res = crow::response(code, result);
         res.add_header("Content-Type", "application/json; charset=utf-8");
-        return res;
+        res.end();
     }
 
 } // namespace crowjourney
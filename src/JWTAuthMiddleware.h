@@ -4,42 +4,85 @@
 #include <crow.h>
 #include <jwt-cpp/jwt.h>
 #include "User.h"
+#include "CacheJetons.h"
+#include "JetonHS256.h"
+#include "CookieParser.h"
+#include "PolitiquesAcces.h"
 #include <chrono>
+#include <memory>
 
 namespace crowjourney {
 
-    class JWTAuthMiddleware : public crow::ILocalMiddleware
+    // Middleware global : la politique de chaque route (ROUTE_ACCES) dit s'il faut un
+    // jeton et quels rôles sont admis
+    class JWTAuthMiddleware
     {
     public:
         struct context
         {
             std::string userId;
             std::string role;
+            std::uint8_t roles{ 0 }; // Bits RoleUser du rôle, pour les contrôles d'accès
             bool authenticated{ false };
         };
 
-        // Constructeur
+        // Constructeur ; avec un nom de cookie, le jeton peut aussi venir de ce cookie
+        // (HttpOnly, posé par /login) quand la requête n'a pas d'en-tête Authorization
         JWTAuthMiddleware(const std::string& secret = "your_super_secret_key_change_me",
             const std::string& issuer = "crowjourney_api",
-            int expiration_hours = 24);
+            int expiration_hours = 24,
+            const std::string& cookie_name = "");
 
-        // Méthodes de gestion des requêtes
-        void before_handle(crow::request& req, crow::response& res, context& ctx);
+        // Méthodes de gestion des requêtes ; Crow passe les contextes des middlewares
+        // précédents : la route reconnue par RoutageMiddleware et les cookies
+        template <typename AllContext>
+        void before_handle(crow::request& req, crow::response& res, context& ctx, AllContext& contextes) {
+            authentifier(req, res, ctx, contextes.template get<RoutageMiddleware>().route.politique,
+                contextes.template get<crow::CookieParser>());
+        }
         void after_handle(crow::request& req, crow::response& res, context& ctx);
 
         // Générer un token JWT pour un utilisateur
         std::string generateToken(const User& user);
 
         // Vérifier si l'utilisateur a un rôle spécifique
-        static bool hasRole(const crow::request& req, const std::string& role);
+        static bool hasRole(const context& ctx, RoleUser role) {
+            return ctx.authenticated && (ctx.roles & role) != 0;
+        }
+
+        // Valeur de l'en-tête Set-Cookie qui transporte le jeton (vide sans cookie configuré) ;
+        // un jeton vide donne le cookie qui efface la session
+        std::string cookieJeton(std::string_view token) const;
+
+        // Taille et taux de succès du cache des jetons vérifiés
+        CacheJetons::Statistiques statistiquesCache() const { return cache_->statistiques(); }
 
     private:
         std::string secret_;
         std::string issuer_;
         int expiration_hours_;
+        std::string cookie_name_;
+
+        // Chemin rapide pour les jetons émis par generateToken
+        JetonHS256 jeton_;
+
+        // Vérificateur générique des jetons d'une autre forme ; construit une fois, la
+        // configuration (algorithme, émetteur) ne change pas d'une requête à l'autre
+        decltype(jwt::verify()) verificateur_;
+
+        // Partagé plutôt que possédé : le middleware est réaffecté après sa construction
+        // par Crow, et le cache (mutex) n'est ni copiable ni déplaçable
+        std::shared_ptr<CacheJetons> cache_;
 
-        // Créer une réponse "unauthorized"
-        crow::response unauthorized(const std::string& message);
+        void authentifier(crow::request& req, crow::response& res, context& ctx,
+            PolitiqueAcces politique, const crow::CookieParser::context& cookies);
+
+        // Vérifier le jeton (cache, chemin rapide, puis vérificateur générique) et remplir
+        // le contexte ; false si la requête a été refusée
+        bool identifier(std::string_view token, context& ctx, crow::response& res);
+
+        // Refuser la requête (401 ou 403) et terminer la réponse
+        static void refuser(crow::response& res, int code, const std::string& message);
     };
 
     // Fonction utilitaire pour obtenir le contexte JWT de la requête
@@ -54,4 +97,10 @@ namespace crowjourney {
         return get_jwt_context<App>(req).authenticated;
     }
 
+    // Fonction utilitaire pour vérifier le rôle de l'utilisateur
+    template<typename App>
+    bool has_role(const crow::request& req, RoleUser role) {
+        return JWTAuthMiddleware::hasRole(get_jwt_context<App>(req), role);
+    }
+
 } // namespace crowjourney
\ No newline at end of file
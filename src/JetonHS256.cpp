@@ -0,0 +1,322 @@
+#include "JetonHS256.h"
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <stdexcept>
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+
+namespace crowjourney {
+
+    namespace {
+
+        // base64url de {"alg":"HS256","typ":"JWT"}, l'en-tête de tous nos jetons
+        // (jwt-cpp sérialisait déjà ses clés dans cet ordre)
+        constexpr std::string_view ENTETE = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9";
+
+        // Charge utile décodée la plus longue traitée sur le chemin rapide
+        constexpr std::size_t TAILLE_MAX_CLAIMS = 2048;
+
+        constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+        constexpr std::array<std::int8_t, 256> TABLE_DECODAGE = [] {
+            std::array<std::int8_t, 256> table{};
+            for (auto& valeur : table) {
+                valeur = -1;
+            }
+            for (int i = 0; i < 64; ++i) {
+                table[static_cast<unsigned char>(ALPHABET[i])] = static_cast<std::int8_t>(i);
+            }
+            return table;
+        }();
+
+        void encoderBase64Url(const std::uint8_t* octets, std::size_t taille, std::string& sortie) {
+            std::size_t i = 0;
+            for (; i + 3 <= taille; i += 3) {
+                std::uint32_t bloc = octets[i] << 16 | octets[i + 1] << 8 | octets[i + 2];
+                sortie += ALPHABET[bloc >> 18];
+                sortie += ALPHABET[(bloc >> 12) & 0x3F];
+                sortie += ALPHABET[(bloc >> 6) & 0x3F];
+                sortie += ALPHABET[bloc & 0x3F];
+            }
+            if (taille - i == 1) {
+                std::uint32_t bloc = octets[i] << 16;
+                sortie += ALPHABET[bloc >> 18];
+                sortie += ALPHABET[(bloc >> 12) & 0x3F];
+            }
+            else if (taille - i == 2) {
+                std::uint32_t bloc = octets[i] << 16 | octets[i + 1] << 8;
+                sortie += ALPHABET[bloc >> 18];
+                sortie += ALPHABET[(bloc >> 12) & 0x3F];
+                sortie += ALPHABET[(bloc >> 6) & 0x3F];
+            }
+        }
+
+        // Décoder du base64url sans remplissage ; renvoie la taille décodée, ou -1 si le
+        // texte est invalide ou ne tient pas dans le tampon
+        std::ptrdiff_t decoderBase64Url(std::string_view texte, std::uint8_t* sortie, std::size_t capacite) {
+            if (texte.size() % 4 == 1 || texte.size() / 4 * 3 + (texte.size() % 4 ? texte.size() % 4 - 1 : 0) > capacite) {
+                return -1;
+            }
+            std::size_t n = 0;
+            std::uint32_t bloc = 0;
+            int bits = 0;
+            for (char c : texte) {
+                std::int8_t valeur = TABLE_DECODAGE[static_cast<unsigned char>(c)];
+                if (valeur < 0) {
+                    return -1;
+                }
+                bloc = bloc << 6 | static_cast<std::uint32_t>(valeur);
+                bits += 6;
+                if (bits >= 8) {
+                    bits -= 8;
+                    sortie[n++] = static_cast<std::uint8_t>(bloc >> bits);
+                }
+            }
+            return static_cast<std::ptrdiff_t>(n);
+        }
+
+        // Claims lus dans la charge utile ; les chaînes pointent dans le tampon décodé
+        struct ClaimsBruts {
+            std::string_view iss, sub, role;
+            std::int64_t exp = 0, iat = 0, nbf = 0;
+            bool a_exp = false, a_iat = false, a_nbf = false;
+        };
+
+        // Lire un objet JSON à plat dont les valeurs sont des chaînes, des entiers ou des
+        // littéraux ; false pour toute autre forme, ou si iss, sub ou role contient un échappement
+        bool lireClaims(std::string_view texte, ClaimsBruts& claims) {
+            std::size_t i = 0;
+            auto espaces = [&]() {
+                while (i < texte.size() && (texte[i] == ' ' || texte[i] == '\t' || texte[i] == '\n' || texte[i] == '\r')) {
+                    ++i;
+                }
+            };
+            auto lireChaine = [&](std::string_view& sortie, bool& echappee) {
+                if (i >= texte.size() || texte[i] != '"') {
+                    return false;
+                }
+                std::size_t debut = ++i;
+                echappee = false;
+                while (i < texte.size() && texte[i] != '"') {
+                    if (texte[i] == '\\') {
+                        echappee = true;
+                        ++i;
+                    }
+                    ++i;
+                }
+                if (i >= texte.size()) {
+                    return false;
+                }
+                sortie = texte.substr(debut, i - debut);
+                ++i;
+                return true;
+            };
+
+            espaces();
+            if (i >= texte.size() || texte[i] != '{') {
+                return false;
+            }
+            ++i;
+            espaces();
+            bool fin_objet = i < texte.size() && texte[i] == '}';
+            if (fin_objet) {
+                ++i;
+            }
+            while (!fin_objet) {
+                espaces();
+                std::string_view cle;
+                bool echappee;
+                if (!lireChaine(cle, echappee) || echappee) {
+                    return false;
+                }
+                espaces();
+                if (i >= texte.size() || texte[i] != ':') {
+                    return false;
+                }
+                ++i;
+                espaces();
+                if (i >= texte.size()) {
+                    return false;
+                }
+
+                const char c = texte[i];
+                if (c == '"') {
+                    std::string_view valeur;
+                    if (!lireChaine(valeur, echappee)) {
+                        return false;
+                    }
+                    std::string_view* cible = cle == "iss" ? &claims.iss
+                        : cle == "sub" ? &claims.sub
+                        : cle == "role" ? &claims.role : nullptr;
+                    if (cible) {
+                        if (echappee) {
+                            return false;
+                        }
+                        *cible = valeur;
+                    }
+                }
+                else if (c == '-' || (c >= '0' && c <= '9')) {
+                    std::int64_t valeur = 0;
+                    auto [fin, erreur] = std::from_chars(texte.data() + i, texte.data() + texte.size(), valeur);
+                    if (erreur != std::errc()) {
+                        return false;
+                    }
+                    i = static_cast<std::size_t>(fin - texte.data());
+                    if (i < texte.size() && (texte[i] == '.' || texte[i] == 'e' || texte[i] == 'E')) {
+                        return false; // Nombre non entier
+                    }
+                    if (cle == "exp") { claims.exp = valeur; claims.a_exp = true; }
+                    else if (cle == "iat") { claims.iat = valeur; claims.a_iat = true; }
+                    else if (cle == "nbf") { claims.nbf = valeur; claims.a_nbf = true; }
+                }
+                else if (texte.substr(i, 4) == "true" || texte.substr(i, 4) == "null") {
+                    i += 4;
+                }
+                else if (texte.substr(i, 5) == "false") {
+                    i += 5;
+                }
+                else {
+                    return false; // Objet ou tableau imbriqué
+                }
+
+                espaces();
+                if (i < texte.size() && texte[i] == ',') {
+                    ++i;
+                }
+                else if (i < texte.size() && texte[i] == '}') {
+                    ++i;
+                    fin_objet = true;
+                }
+                else {
+                    return false;
+                }
+            }
+            espaces();
+            return i == texte.size();
+        }
+
+        // Contexte HMAC d'un thread, chargé avec la clé d'une instance de JetonHS256
+        struct ContexteHmac {
+            EVP_MAC_CTX* ctx = nullptr;
+            std::uint64_t instance = 0; // 0 : aucune clé chargée
+            ~ContexteHmac() { EVP_MAC_CTX_free(ctx); }
+        };
+
+        EVP_MAC* algorithmeHmac() {
+            static EVP_MAC* mac = EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr);
+            return mac;
+        }
+
+        std::atomic<std::uint64_t> prochaine_instance{ 1 };
+    }
+
+    JetonHS256::JetonHS256(std::string secret, std::string emetteur)
+        : secret_(std::move(secret)), emetteur_(std::move(emetteur)), instance_(prochaine_instance++) {
+    }
+
+    bool JetonHS256::hmac(std::string_view donnees, std::uint8_t (&sortie)[32]) const {
+        thread_local ContexteHmac local;
+        if (!local.ctx) {
+            local.ctx = EVP_MAC_CTX_new(algorithmeHmac());
+            if (!local.ctx) {
+                return false;
+            }
+        }
+
+        int ok;
+        if (local.instance != instance_) {
+            char digest[] = "SHA256";
+            OSSL_PARAM parametres[] = {
+                OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+                OSSL_PARAM_construct_end()
+            };
+            ok = EVP_MAC_init(local.ctx, reinterpret_cast<const unsigned char*>(secret_.data()), secret_.size(), parametres);
+            local.instance = ok ? instance_ : 0;
+        }
+        else {
+            ok = EVP_MAC_init(local.ctx, nullptr, 0, nullptr); // Même clé : repartir sans la recharger
+        }
+
+        std::size_t taille = 0;
+        return ok == 1
+            && EVP_MAC_update(local.ctx, reinterpret_cast<const unsigned char*>(donnees.data()), donnees.size()) == 1
+            && EVP_MAC_final(local.ctx, sortie, &taille, sizeof(sortie)) == 1
+            && taille == sizeof(sortie);
+    }
+
+    JetonHS256::Resultat JetonHS256::verifier(std::string_view jeton, std::int64_t maintenant, Claims& claims) const {
+        const std::size_t point1 = jeton.find('.');
+        const std::size_t point2 = point1 == std::string_view::npos ? point1 : jeton.find('.', point1 + 1);
+        if (point2 == std::string_view::npos || jeton.find('.', point2 + 1) != std::string_view::npos) {
+            return { Statut::Invalide, "Jeton mal formé" };
+        }
+        if (jeton.substr(0, point1) != ENTETE) {
+            return { Statut::FormeInconnue, nullptr };
+        }
+
+        // Signature d'abord : rien de la charge utile n'est lu avant d'être authentifié
+        std::uint8_t signature[32];
+        std::uint8_t attendue[32];
+        if (decoderBase64Url(jeton.substr(point2 + 1), signature, sizeof(signature)) != sizeof(signature)) {
+            return { Statut::Invalide, "Signature invalide" };
+        }
+        if (!hmac(jeton.substr(0, point2), attendue)) {
+            return { Statut::Invalide, "Échec du calcul de la signature" };
+        }
+        if (CRYPTO_memcmp(signature, attendue, sizeof(signature)) != 0) {
+            return { Statut::Invalide, "Signature invalide" };
+        }
+
+        std::uint8_t charge[TAILLE_MAX_CLAIMS];
+        std::ptrdiff_t taille = decoderBase64Url(jeton.substr(point1 + 1, point2 - point1 - 1), charge, sizeof(charge));
+        ClaimsBruts bruts;
+        if (taille < 0 || !lireClaims(std::string_view(reinterpret_cast<const char*>(charge), static_cast<std::size_t>(taille)), bruts)
+            || !bruts.a_exp || bruts.sub.empty() || bruts.role.empty()) {
+            return { Statut::FormeInconnue, nullptr };
+        }
+
+        if (bruts.iss != emetteur_) {
+            return { Statut::Invalide, "Émetteur invalide" };
+        }
+        if (maintenant > bruts.exp) {
+            return { Statut::Invalide, "Jeton expiré" };
+        }
+        if ((bruts.a_iat && bruts.iat > maintenant) || (bruts.a_nbf && bruts.nbf > maintenant)) {
+            return { Statut::Invalide, "Jeton pas encore valide" };
+        }
+
+        claims.sub.assign(bruts.sub);
+        claims.role.assign(bruts.role);
+        claims.exp = bruts.exp;
+        return { Statut::Valide, nullptr };
+    }
+
+    bool JetonHS256::signature(std::string_view jeton, std::uint8_t (&sortie)[32]) {
+        const std::size_t point1 = jeton.find('.');
+        const std::size_t point2 = jeton.rfind('.');
+        if (point1 == std::string_view::npos || point2 == point1) {
+            return false;
+        }
+        return decoderBase64Url(jeton.substr(point2 + 1), sortie, sizeof(sortie)) == sizeof(sortie);
+    }
+
+    std::string JetonHS256::signer(std::string_view claims_json) const {
+        std::string jeton;
+        jeton.reserve(ENTETE.size() + 2 + (claims_json.size() * 4 + 2) / 3 + 43);
+        jeton += ENTETE;
+        jeton += '.';
+        encoderBase64Url(reinterpret_cast<const std::uint8_t*>(claims_json.data()), claims_json.size(), jeton);
+
+        std::uint8_t signature[32];
+        if (!hmac(jeton, signature)) {
+            throw std::runtime_error("Échec de la signature du jeton");
+        }
+        jeton += '.';
+        encoderBase64Url(signature, sizeof(signature), jeton);
+        return jeton;
+    }
+
+} // namespace crowjourney
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace crowjourney {
+
+    // Signature et vérification HS256 des jetons émis par l'API, sans passer par jwt-cpp.
+    //
+    // La vérification ne traite que la forme de nos propres jetons : en-tête
+    // {"alg":"HS256","typ":"JWT"} et claims à plat (chaînes et nombres). Elle travaille
+    // sur des string_view, décode le base64url dans des tampons sur la pile et calcule
+    // le HMAC avec un contexte OpenSSL propre à chaque thread, chargé une fois avec la clé.
+    // Un jeton d'une autre forme est signalé comme tel, pour que l'appelant le confie à
+    // un vérificateur générique.
+    class JetonHS256 {
+    public:
+        enum class Statut {
+            Valide,
+            Invalide,      // Signature, émetteur ou dates refusés
+            FormeInconnue  // Jeton bien formé peut-être, mais hors du chemin rapide
+        };
+
+        struct Resultat {
+            Statut statut;
+            const char* erreur; // Raison du refus (littéral), nullptr si valide
+        };
+
+        // Claims utiles à l'authentification
+        struct Claims {
+            std::string sub;
+            std::string role;
+            std::int64_t exp = 0; // Secondes depuis l'epoch
+        };
+
+        JetonHS256(std::string secret, std::string emetteur);
+
+        // Vérifier la signature, l'émetteur (iss) et les dates (exp, iat, nbf) par rapport
+        // à maintenant (secondes depuis l'epoch) ; les claims ne sont remplis que si le jeton est valide
+        Resultat verifier(std::string_view jeton, std::int64_t maintenant, Claims& claims) const;
+
+        // Jeton signé pour un objet JSON de claims déjà sérialisé
+        std::string signer(std::string_view claims_json) const;
+
+        // Signature décodée (dernier segment) d'un jeton HS256 ; false si le jeton n'a pas
+        // trois segments ou si la signature ne fait pas 32 octets. Rien n'est vérifié.
+        static bool signature(std::string_view jeton, std::uint8_t (&sortie)[32]);
+
+    private:
+        std::string secret_;
+        std::string emetteur_;
+        std::uint64_t instance_; // Distingue les clés chargées dans les contextes HMAC des threads
+
+        // HMAC-SHA256 de donnees ; false si OpenSSL échoue
+        bool hmac(std::string_view donnees, std::uint8_t (&sortie)[32]) const;
+    };
+
+} // namespace crowjourney
@@ -0,0 +1,387 @@
+#include "Journal.h"
+#include "Metriques.h"
+#include "Traces.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace crowjourney {
+
+    namespace {
+
+        // Forcer l'écriture des données du fichier sur le disque
+        bool synchroniser(std::FILE* fichier) {
+            if (std::fflush(fichier) != 0) {
+                return false;
+            }
+#ifdef _WIN32
+            return _commit(_fileno(fichier)) == 0;
+#else
+            return fsync(fileno(fichier)) == 0;
+#endif
+        }
+
+        // Rendre durable un renommage en synchronisant le répertoire parent
+        void synchroniserRepertoire(const std::string& chemin) {
+#ifndef _WIN32
+            auto parent = std::filesystem::absolute(chemin).parent_path();
+            int fd = ::open(parent.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                fsync(fd);
+                ::close(fd);
+            }
+#endif
+        }
+
+        // Ajouter le contenu de source à la fin de destination, puis synchroniser celle-ci.
+        // En cas d'échec, destination est ramenée à sa taille d'origine
+        bool ajouterFichier(const std::string& source, const std::string& destination) {
+            std::FILE* entree = std::fopen(source.c_str(), "rb");
+            if (!entree) {
+                return false;
+            }
+            std::FILE* sortie = std::fopen(destination.c_str(), "ab");
+            if (!sortie) {
+                std::fclose(entree);
+                return false;
+            }
+            long taille_initiale = std::fseek(sortie, 0, SEEK_END) == 0 ? std::ftell(sortie) : -1;
+            bool ok = taille_initiale >= 0;
+
+            char tampon[64 * 1024];
+            std::size_t lus;
+            while (ok && (lus = std::fread(tampon, 1, sizeof(tampon), entree)) > 0) {
+                ok = std::fwrite(tampon, 1, lus, sortie) == lus;
+            }
+            ok = ok && !std::ferror(entree) && synchroniser(sortie);
+            std::fclose(entree);
+            std::fclose(sortie);
+
+            if (!ok && taille_initiale >= 0) {
+                std::error_code erreur;
+                std::filesystem::resize_file(destination, static_cast<std::uintmax_t>(taille_initiale), erreur);
+            }
+            return ok;
+        }
+    }
+
+    bool ecrireFichierAtomique(const std::string& chemin, const std::string& contenu) {
+        const std::string temporaire = chemin + ".tmp";
+
+        std::FILE* fichier = std::fopen(temporaire.c_str(), "wb");
+        if (!fichier) {
+            TRACE_ERREUR("Impossible d'ouvrir un fichier en écriture", traces::champ("chemin", temporaire));
+            return false;
+        }
+        bool ok = std::fwrite(contenu.data(), 1, contenu.size(), fichier) == contenu.size();
+        ok = synchroniser(fichier) && ok;
+        std::fclose(fichier);
+
+        std::error_code erreur;
+        if (ok) {
+            std::filesystem::rename(temporaire, chemin, erreur);
+            ok = !erreur;
+        }
+        if (!ok) {
+            TRACE_ERREUR("Échec de l'écriture atomique", traces::champ("chemin", chemin));
+            std::filesystem::remove(temporaire, erreur);
+            return false;
+        }
+        synchroniserRepertoire(chemin);
+        return true;
+    }
+
+    Journal::Journal(std::string chemin, std::chrono::milliseconds intervalle, std::size_t seuil_octets)
+        : chemin_(std::move(chemin)), chemin_ancien_(chemin_ + ".old"),
+        intervalle_(intervalle), seuil_octets_(seuil_octets) {
+    }
+
+    Journal::~Journal() {
+        {
+            std::lock_guard<std::mutex> verrou(tampon_mutex_);
+            arret_ = true;
+        }
+        tampon_cv_.notify_one();
+        if (vidage_.joinable()) {
+            vidage_.join();
+        }
+        // Dernier vidage des enregistrements acquittés immédiatement
+        vider();
+        if (fichier_) {
+            std::fclose(fichier_);
+        }
+    }
+
+    std::size_t Journal::rejouerFichier(const std::string& chemin, std::uint64_t depuis,
+        const std::function<void(const json&)>& appliquer) {
+        std::ifstream fichier(chemin, std::ios::binary);
+        if (!fichier.is_open()) {
+            return 0;
+        }
+
+        std::size_t appliques = 0;
+        std::uintmax_t fin_valide = 0;
+        std::size_t numero = 0;
+        std::string ligne;
+        while (std::getline(fichier, ligne)) {
+            ++numero;
+            if (ligne.empty()) {
+                fin_valide += 1;
+                continue;
+            }
+            // Chaque enregistrement est écrit avec son saut de ligne : une ligne qui n'en a
+            // pas est la fin d'une écriture interrompue par un arrêt brutal
+            const bool tronquee = fichier.eof();
+            json enregistrement = tronquee ? json(json::value_t::discarded) : json::parse(ligne, nullptr, false);
+            if (enregistrement.is_discarded() || !enregistrement.contains("seq") || !enregistrement["seq"].is_number_unsigned()) {
+                if (!tronquee) {
+                    // Au milieu du fichier, ce n'est plus un arrêt brutal : tronquer perdrait
+                    // les enregistrements suivants, déjà acquittés
+                    TRACE_ERREUR("Journal corrompu", traces::champ("chemin", chemin), traces::champ("ligne", numero));
+                    throw ErreurJournal("Journal corrompu: " + chemin + ", ligne " + std::to_string(numero));
+                }
+                // Dernière ligne tronquée : elle est retirée pour que les prochains ajouts
+                // ne se retrouvent pas derrière un enregistrement illisible
+                TRACE_AVERTISSEMENT("Dernier enregistrement du journal tronqué, retiré", traces::champ("chemin", chemin));
+                fichier.close();
+                std::error_code erreur;
+                std::filesystem::resize_file(chemin, fin_valide, erreur);
+                break;
+            }
+            fin_valide += ligne.size() + 1;
+            std::uint64_t seq = enregistrement["seq"].get<std::uint64_t>();
+            if (seq > sequence_.load()) {
+                sequence_.store(seq);
+            }
+            if (seq <= depuis) {
+                continue;
+            }
+            appliquer(enregistrement);
+            ++appliques;
+        }
+        return appliques;
+    }
+
+    std::size_t Journal::rejouer(std::uint64_t depuis, const std::function<void(const json&)>& appliquer) {
+        if (depuis > sequence_.load()) {
+            sequence_.store(depuis);
+        }
+        std::size_t appliques = rejouerFichier(chemin_ancien_, depuis, appliquer);
+        appliques += rejouerFichier(chemin_, depuis, appliquer);
+        depuis_compaction_ = appliques;
+
+        // Tout ce qui a été relu est déjà sur disque
+        std::lock_guard<std::mutex> verrou(tampon_mutex_);
+        sequence_tampon_ = sequence_durable_ = sequence_.load();
+        return appliques;
+    }
+
+    bool Journal::ouvrir() {
+        {
+            std::lock_guard<std::mutex> verrou(fichier_mutex_);
+            if (!fichier_) {
+                fichier_ = std::fopen(chemin_.c_str(), "ab");
+                if (!fichier_) {
+                    TRACE_ERREUR("Impossible d'ouvrir le journal", traces::champ("chemin", chemin_));
+                    return false;
+                }
+            }
+        }
+        if (!vidage_.joinable()) {
+            vidage_ = std::thread(&Journal::boucleVidage, this);
+        }
+        return true;
+    }
+
+    std::uint64_t Journal::ajouter(json enregistrement) {
+        // La séquence n'est consommée qu'une fois l'enregistrement sérialisé
+        const std::uint64_t seq = sequence_.load() + 1;
+        enregistrement["seq"] = seq;
+        std::string ligne = enregistrement.dump();
+        ligne.push_back('\n');
+        sequence_.store(seq);
+        ++depuis_compaction_;
+
+        bool plein;
+        {
+            std::lock_guard<std::mutex> verrou(tampon_mutex_);
+            tampon_ += ligne;
+            sequence_tampon_ = seq;
+            plein = tampon_.size() >= seuil_octets_;
+        }
+        if (plein) {
+            tampon_cv_.notify_one();
+        }
+        return seq;
+    }
+
+    void Journal::attendreDurabilite(std::uint64_t sequence) {
+        // Un échec antérieur à l'attente ne compte pas : la séquence a été remise dans le
+        // tampon et le prochain vidage la retente
+        std::unique_lock<std::mutex> verrou(tampon_mutex_);
+        const std::uint64_t tentative = tentatives_;
+        durable_cv_.wait(verrou, [this, sequence, tentative]() {
+            return sequence_durable_ >= sequence || arret_
+                || (tentatives_ != tentative && sequence_echec_ >= sequence);
+        });
+        if (sequence_durable_ < sequence) {
+            throw ErreurJournal("Écriture non synchronisée sur disque");
+        }
+    }
+
+    void Journal::vider() {
+        std::lock_guard<std::mutex> verrou(fichier_mutex_);
+        ecrireLot();
+    }
+
+    bool Journal::ecrireLot() {
+        std::string lot;
+        std::uint64_t jusqua;
+        {
+            std::lock_guard<std::mutex> verrou(tampon_mutex_);
+            lot.swap(tampon_);
+            jusqua = sequence_tampon_;
+        }
+
+        bool ok = true;
+        if (!lot.empty()) {
+            metriques::Chrono chrono(metriques::Etape::VidageJournal);
+            const long debut = fichier_ && std::fseek(fichier_, 0, SEEK_END) == 0 ? std::ftell(fichier_) : -1;
+            ok = debut >= 0
+                && std::fwrite(lot.data(), 1, lot.size(), fichier_) == lot.size()
+                && synchroniser(fichier_);
+            if (!ok) {
+                TRACE_ERREUR("Échec de l'écriture dans le journal", traces::champ("chemin", chemin_),
+                    traces::champ("octets", lot.size()));
+                // Retirer une écriture partielle (et ce qui resterait dans le tampon de
+                // stdio) : le lot entier sera réécrit au prochain vidage
+                if (debut >= 0) {
+                    std::fclose(fichier_);
+                    std::error_code erreur;
+                    std::filesystem::resize_file(chemin_, static_cast<std::uintmax_t>(debut), erreur);
+                    fichier_ = std::fopen(chemin_.c_str(), "ab");
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> verrou(tampon_mutex_);
+            if (ok) {
+                if (jusqua > sequence_durable_) {
+                    sequence_durable_ = jusqua;
+                }
+            }
+            else {
+                // Le lot repasse devant les ajouts arrivés entre-temps ; la séquence durable n'avance pas
+                lot += tampon_;
+                tampon_.swap(lot);
+            }
+            ++tentatives_;
+            sequence_echec_ = ok ? 0 : jusqua;
+        }
+        durable_cv_.notify_all();
+        return ok;
+    }
+
+    // Thread de vidage : un fsync par lot, quel que soit le nombre d'écrivains en attente
+    void Journal::boucleVidage() {
+        std::unique_lock<std::mutex> verrou(tampon_mutex_);
+        while (!arret_) {
+            tampon_cv_.wait_for(verrou, intervalle_, [this]() {
+                return arret_ || tampon_.size() >= seuil_octets_;
+            });
+            if (tampon_.empty()) {
+                continue;
+            }
+            verrou.unlock();
+            bool ok;
+            {
+                std::lock_guard<std::mutex> fichier(fichier_mutex_);
+                ok = ecrireLot();
+            }
+            verrou.lock();
+            if (!ok) {
+                // Laisser passer un intervalle avant de réessayer, même si le tampon est plein
+                tampon_cv_.wait_for(verrou, intervalle_, [this]() { return arret_; });
+            }
+        }
+    }
+
+    bool Journal::compactionInterrompue() const {
+        std::error_code erreur;
+        return std::filesystem::exists(chemin_ancien_, erreur);
+    }
+
+    bool Journal::pivoter() {
+        bool attendu = false;
+        if (!compaction_en_cours_.compare_exchange_strong(attendu, true)) {
+            return false;
+        }
+
+        // Le lot en attente appartient au segment qui part en compaction ; s'il ne peut pas
+        // être écrit, la compaction attendra
+        std::lock_guard<std::mutex> verrou(fichier_mutex_);
+        if (!ecrireLot()) {
+            compaction_en_cours_.store(false);
+            return false;
+        }
+        if (fichier_) {
+            std::fclose(fichier_);
+            fichier_ = nullptr;
+        }
+
+        // Un ancien segment non supprimé est conservé : il est couvert par l'instantané à venir.
+        // Le segment courant n'est supprimé qu'une fois recopié et synchronisé ; sinon les deux
+        // fichiers restent en place et la compaction est abandonnée
+        std::error_code erreur;
+        bool ok;
+        if (std::filesystem::exists(chemin_ancien_, erreur)) {
+            ok = ajouterFichier(chemin_, chemin_ancien_);
+            if (ok) {
+                std::filesystem::remove(chemin_, erreur);
+                ok = !erreur;
+            }
+        }
+        else {
+            std::filesystem::rename(chemin_, chemin_ancien_, erreur);
+            ok = !erreur;
+        }
+        if (ok) {
+            synchroniserRepertoire(chemin_);
+        }
+        else {
+            TRACE_ERREUR("Impossible de mettre le segment du journal de côté", traces::champ("chemin", chemin_));
+        }
+
+        fichier_ = std::fopen(chemin_.c_str(), "ab");
+        if (!fichier_) {
+            TRACE_ERREUR("Impossible d'ouvrir le journal", traces::champ("chemin", chemin_));
+        }
+        if (!ok) {
+            abandonnerCompaction();
+            return false;
+        }
+        depuis_compaction_ = 0;
+        return true;
+    }
+
+    void Journal::abandonnerCompaction() {
+        compaction_en_cours_.store(false);
+    }
+
+    void Journal::terminerCompaction() {
+        std::error_code erreur;
+        std::filesystem::remove(chemin_ancien_, erreur);
+        compaction_en_cours_.store(false);
+    }
+
+} // namespace crowjourney
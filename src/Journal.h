@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+namespace crowjourney {
+
+    // Écrire un fichier de façon atomique : fichier temporaire, fsync puis renommage.
+    // Renvoie false si l'écriture a échoué (le fichier existant est alors intact).
+    bool ecrireFichierAtomique(const std::string& chemin, const std::string& contenu);
+
+    // Écriture du journal impossible (disque plein, erreur d'E/S) : la séquence attendue
+    // n'est pas durable, la requête ne doit pas être acquittée
+    class ErreurJournal : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Moment où une écriture est confirmée au client
+    enum class Acquittement {
+        Durable,  // Après la synchronisation sur disque du lot qui la contient
+        Immediat  // Dès qu'elle est visible en mémoire (perdue si le serveur s'arrête avant le vidage)
+    };
+
+    // Journal d'écriture anticipée (write-ahead log) : un enregistrement JSON par ligne,
+    // numéroté par une séquence croissante.
+    //
+    // Les ajouts sont regroupés en mémoire ; un thread de fond les écrit et les synchronise
+    // sur disque par lots (group commit), toutes les `intervalle` ou dès que le tampon
+    // dépasse `seuil_octets`. attendreDurabilite() bloque jusqu'au vidage d'une séquence.
+    //
+    // La compaction se fait en deux temps : pivoter() met le segment courant de côté
+    // (fichier ".old") et en ouvre un nouveau, puis, une fois l'instantané écrit,
+    // terminerCompaction() supprime l'ancien segment. Au rechargement, les enregistrements
+    // déjà couverts par l'instantané sont ignorés grâce à leur numéro de séquence.
+    //
+    // ajouter() et pivoter() doivent être appelés sous le verrou d'écriture du gestionnaire ;
+    // attendreDurabilite() doit l'être après l'avoir relâché.
+    class Journal {
+    public:
+        explicit Journal(std::string chemin,
+            std::chrono::milliseconds intervalle = std::chrono::milliseconds(5),
+            std::size_t seuil_octets = 64 * 1024);
+        ~Journal();
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        // Rejouer les enregistrements dont la séquence est supérieure à depuis. Une dernière
+        // ligne tronquée est retirée ; un enregistrement illisible ailleurs lève ErreurJournal
+        std::size_t rejouer(std::uint64_t depuis, const std::function<void(const nlohmann::json&)>& appliquer);
+
+        // Ouvrir le segment courant en ajout et démarrer le thread de vidage
+        bool ouvrir();
+
+        // Ajouter un enregistrement (le champ "seq" est renseigné) ; renvoie sa séquence sans attendre le disque
+        std::uint64_t ajouter(nlohmann::json enregistrement);
+
+        // Attendre que la séquence soit synchronisée sur disque ; lève ErreurJournal si un
+        // vidage tenté pendant l'attente, et qui contenait la séquence, a échoué (le lot est
+        // conservé et réessayé au vidage suivant : l'écriture peut encore devenir durable)
+        void attendreDurabilite(std::uint64_t sequence);
+
+        // Écrire et synchroniser immédiatement les enregistrements en attente
+        void vider();
+
+        std::uint64_t derniereSequence() const { return sequence_.load(); }
+
+        // Nombre d'enregistrements écrits depuis la dernière compaction
+        std::size_t enregistrementsDepuisCompaction() const { return depuis_compaction_; }
+
+        // Un ancien segment subsiste (compaction interrompue par un arrêt)
+        bool compactionInterrompue() const;
+
+        // Commencer une compaction ; false si une compaction est déjà en cours, ou si le
+        // segment courant n'a pas pu être écrit, recopié ou renommé (les fichiers sont alors
+        // laissés en place)
+        bool pivoter();
+
+        // Terminer la compaction une fois l'instantané durable
+        void terminerCompaction();
+
+        // Abandonner une compaction dont l'instantané n'a pas pu être écrit ;
+        // l'ancien segment est conservé et fusionné lors de la prochaine compaction
+        void abandonnerCompaction();
+
+    private:
+        std::string chemin_;
+        std::string chemin_ancien_;
+        std::chrono::milliseconds intervalle_;
+        std::size_t seuil_octets_;
+
+        // Segment courant, protégé par fichier_mutex_
+        std::mutex fichier_mutex_;
+        std::FILE* fichier_ = nullptr;
+
+        // Lot en attente de vidage, protégé par tampon_mutex_
+        std::mutex tampon_mutex_;
+        std::condition_variable tampon_cv_;    // Réveille le thread de vidage
+        std::condition_variable durable_cv_;   // Réveille les écrivains en attente
+        std::string tampon_;
+        std::uint64_t sequence_tampon_ = 0;    // Dernière séquence présente dans le tampon
+        std::uint64_t sequence_durable_ = 0;   // Dernière séquence synchronisée sur disque
+        std::uint64_t tentatives_ = 0;         // Vidages tentés, réussis ou non
+        std::uint64_t sequence_echec_ = 0;     // Dernière séquence du dernier vidage s'il a échoué, 0 sinon
+        bool arret_ = false;
+        std::thread vidage_;
+
+        std::atomic<std::uint64_t> sequence_{ 0 };
+        std::size_t depuis_compaction_ = 0;
+        std::atomic<bool> compaction_en_cours_{ false };
+
+        std::size_t rejouerFichier(const std::string& chemin, std::uint64_t depuis,
+            const std::function<void(const nlohmann::json&)>& appliquer);
+        void boucleVidage();
+        bool ecrireLot(); // Appelé avec fichier_mutex_ verrouillé ; false si le lot n'est pas durable
+    };
+
+} // namespace crowjourney
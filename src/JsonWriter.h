@@ -0,0 +1,237 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace crowjourney {
+
+    // Écriture directe de JSON dans un tampon, sans construire de DOM.
+    // Les virgules sont gérées automatiquement ; les chaînes sont échappées et les
+    // séquences UTF-8 invalides remplacées par U+FFFD pour garantir un JSON valide.
+    //
+    //   JsonWriter sortie;
+    //   sortie.debutObjet().champ("id", 3).champ("titre", titre).finObjet();
+    //   crow::response(200, sortie.prendre());
+    class JsonWriter {
+    public:
+        explicit JsonWriter(std::size_t capacite = 256) {
+            tampon_.reserve(capacite);
+        }
+
+        JsonWriter& debutObjet() {
+            separateur();
+            tampon_.push_back('{');
+            virgule_ = false;
+            return *this;
+        }
+
+        JsonWriter& finObjet() {
+            tampon_.push_back('}');
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& debutTableau() {
+            separateur();
+            tampon_.push_back('[');
+            virgule_ = false;
+            return *this;
+        }
+
+        JsonWriter& finTableau() {
+            tampon_.push_back(']');
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& cle(std::string_view nom) {
+            separateur();
+            chaine(nom);
+            tampon_.push_back(':');
+            virgule_ = false;
+            return *this;
+        }
+
+        JsonWriter& valeur(std::string_view texte) {
+            separateur();
+            chaine(texte);
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& valeur(const char* texte) { return valeur(std::string_view(texte)); }
+        JsonWriter& valeur(const std::string& texte) { return valeur(std::string_view(texte)); }
+
+        JsonWriter& valeur(std::int64_t nombre) {
+            separateur();
+            entier(nombre);
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& valeur(int nombre) { return valeur(static_cast<std::int64_t>(nombre)); }
+        JsonWriter& valeur(std::uint64_t nombre) { return valeur(static_cast<std::int64_t>(nombre)); }
+
+        // Représentation la plus courte relue à l'identique ; null pour NaN et l'infini
+        JsonWriter& valeur(double nombre) {
+            separateur();
+            if (std::isfinite(nombre)) {
+                char chiffres[32];
+                auto resultat = std::to_chars(chiffres, chiffres + sizeof(chiffres), nombre);
+                tampon_.append(chiffres, resultat.ptr);
+            }
+            else {
+                tampon_.append("null");
+            }
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& valeur(bool booleen) {
+            separateur();
+            tampon_.append(booleen ? "true" : "false");
+            virgule_ = true;
+            return *this;
+        }
+
+        JsonWriter& valeurNulle() {
+            separateur();
+            tampon_.append("null");
+            virgule_ = true;
+            return *this;
+        }
+
+        // Fragment JSON déjà sérialisé, inséré tel quel
+        JsonWriter& brut(std::string_view fragment) {
+            separateur();
+            tampon_.append(fragment);
+            virgule_ = true;
+            return *this;
+        }
+
+        template <typename T>
+        JsonWriter& champ(std::string_view nom, const T& v) {
+            cle(nom);
+            return valeur(v);
+        }
+
+        const std::string& str() const { return tampon_; }
+
+        // Récupérer le contenu (le tampon est laissé vide)
+        std::string prendre() {
+            virgule_ = false;
+            return std::move(tampon_);
+        }
+
+        // Vider le tampon en conservant sa capacité, pour le réutiliser
+        void effacer() {
+            tampon_.clear();
+            virgule_ = false;
+        }
+
+        // {"cle": "valeur"} : corps des réponses d'erreur et de message
+        static std::string objet(std::string_view nom, std::string_view texte) {
+            JsonWriter sortie(nom.size() + texte.size() + 16);
+            sortie.debutObjet().champ(nom, texte).finObjet();
+            return sortie.prendre();
+        }
+
+    private:
+        std::string tampon_;
+        bool virgule_ = false;
+
+        void separateur() {
+            if (virgule_) {
+                tampon_.push_back(',');
+            }
+        }
+
+        void entier(std::int64_t nombre) {
+            char chiffres[24];
+            char* fin = chiffres + sizeof(chiffres);
+            char* p = fin;
+            std::uint64_t absolu = nombre < 0 ? 0 - static_cast<std::uint64_t>(nombre) : static_cast<std::uint64_t>(nombre);
+            do {
+                *--p = static_cast<char>('0' + absolu % 10);
+                absolu /= 10;
+            } while (absolu != 0);
+            if (nombre < 0) {
+                *--p = '-';
+            }
+            tampon_.append(p, fin);
+        }
+
+        // Longueur d'une séquence UTF-8 valide commençant à i, 0 si invalide
+        static std::size_t longueurUtf8(std::string_view texte, std::size_t i) {
+            const auto octet = [&](std::size_t k) { return static_cast<unsigned char>(texte[k]); };
+            const unsigned char c = octet(i);
+            std::size_t n;
+            std::uint32_t point;
+            if (c >= 0xC2 && c <= 0xDF) { n = 2; point = c & 0x1F; }
+            else if (c >= 0xE0 && c <= 0xEF) { n = 3; point = c & 0x0F; }
+            else if (c >= 0xF0 && c <= 0xF4) { n = 4; point = c & 0x07; }
+            else return 0;
+
+            if (i + n > texte.size()) return 0;
+            for (std::size_t k = 1; k < n; ++k) {
+                if ((octet(i + k) & 0xC0) != 0x80) return 0;
+                point = (point << 6) | (octet(i + k) & 0x3F);
+            }
+            // Formes trop longues, surrogates et points hors Unicode
+            if ((n == 3 && point < 0x800) || (n == 4 && (point < 0x10000 || point > 0x10FFFF))
+                || (point >= 0xD800 && point <= 0xDFFF)) {
+                return 0;
+            }
+            return n;
+        }
+
+        void chaine(std::string_view texte) {
+            static const char hex[] = "0123456789abcdef";
+            tampon_.push_back('"');
+            std::size_t debut = 0; // Début du segment à recopier sans transformation
+            std::size_t i = 0;
+            while (i < texte.size()) {
+                const unsigned char c = static_cast<unsigned char>(texte[i]);
+                if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80) {
+                    ++i;
+                    continue;
+                }
+                if (c >= 0x80) {
+                    std::size_t n = longueurUtf8(texte, i);
+                    if (n != 0) {
+                        i += n;
+                        continue;
+                    }
+                }
+
+                tampon_.append(texte.data() + debut, i - debut);
+                switch (c) {
+                case '"': tampon_.append("\\\""); break;
+                case '\\': tampon_.append("\\\\"); break;
+                case '\n': tampon_.append("\\n"); break;
+                case '\r': tampon_.append("\\r"); break;
+                case '\t': tampon_.append("\\t"); break;
+                case '\b': tampon_.append("\\b"); break;
+                case '\f': tampon_.append("\\f"); break;
+                default:
+                    if (c < 0x20) {
+                        const char echappement[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+                        tampon_.append(echappement, sizeof(echappement));
+                    }
+                    else {
+                        tampon_.append("\\ufffd"); // Octet UTF-8 invalide
+                    }
+                }
+                ++i;
+                debut = i;
+            }
+            tampon_.append(texte.data() + debut, texte.size() - debut);
+            tampon_.push_back('"');
+        }
+    };
+
+} // namespace crowjourney
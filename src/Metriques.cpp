@@ -0,0 +1,269 @@
+#include "Metriques.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "PolitiquesAcces.h"
+
+namespace crowjourney::metriques {
+
+    namespace {
+        constexpr std::size_t MAX_ROUTES = 64; // Au-delà, les routes sont comptées avec la route 0
+
+        // Intervalles des histogrammes : [0, 1024 ns), puis 4 par octave jusqu'à 2^36 ns, puis +Inf
+        constexpr int OCTAVE_MIN = 10;
+        constexpr int OCTAVE_MAX = 36;
+        constexpr int SOUS_BITS = 2;
+        constexpr std::size_t INTERVALLES = 1 + (OCTAVE_MAX - OCTAVE_MIN) * (1u << SOUS_BITS) + 1;
+
+        // Statuts comptés séparément ; les autres le sont par classe (1xx à 5xx)
+        constexpr std::array<int, 11> STATUTS = { 200, 201, 204, 304, 400, 401, 403, 404, 409, 500, 503 };
+        constexpr std::size_t NOMBRE_STATUTS = STATUTS.size() + 5;
+
+        constexpr std::size_t NOMBRE_ETAPES = static_cast<std::size_t>(Etape::Nombre);
+        constexpr std::array<std::string_view, NOMBRE_ETAPES> NOMS_ETAPES = {
+            "jwt_verify", "json_parse", "serialize", "journal_flush", "snapshot_write"
+        };
+
+        std::size_t intervalle(std::uint64_t ns) {
+            if (ns < (std::uint64_t{ 1 } << OCTAVE_MIN)) {
+                return 0;
+            }
+            const int octave = std::bit_width(ns) - 1;
+            if (octave >= OCTAVE_MAX) {
+                return INTERVALLES - 1;
+            }
+            const std::size_t sous = (ns >> (octave - SOUS_BITS)) & ((1u << SOUS_BITS) - 1);
+            return 1 + static_cast<std::size_t>(octave - OCTAVE_MIN) * (1u << SOUS_BITS) + sous;
+        }
+
+        // Borne supérieure de l'intervalle i, en nanosecondes (l'intervalle +Inf exclu)
+        std::uint64_t borne(std::size_t i) {
+            if (i == 0) {
+                return std::uint64_t{ 1 } << OCTAVE_MIN;
+            }
+            const std::size_t octave = OCTAVE_MIN + (i - 1) / (1u << SOUS_BITS);
+            const std::size_t sous = (i - 1) % (1u << SOUS_BITS);
+            return ((1u << SOUS_BITS) + sous + 1) << (octave - SOUS_BITS);
+        }
+
+        std::size_t indiceStatut(int statut) {
+            for (std::size_t i = 0; i < STATUTS.size(); ++i) {
+                if (STATUTS[i] == statut) {
+                    return i;
+                }
+            }
+            const int classe = statut < 100 ? 1 : statut >= 600 ? 5 : statut / 100;
+            return STATUTS.size() + static_cast<std::size_t>(classe - 1);
+        }
+
+        // Un seul thread écrit dans un compteur : chargement et stockage relâchés, sans
+        // fetch_add ; l'export lit des valeurs peut-être en retard d'un enregistrement
+        using Compteur = std::atomic<std::uint64_t>;
+
+        inline void ajouter(Compteur& compteur, std::uint64_t valeur) {
+            compteur.store(compteur.load(std::memory_order_relaxed) + valeur, std::memory_order_relaxed);
+        }
+
+        struct Histogramme {
+            std::array<Compteur, INTERVALLES> intervalles{};
+            Compteur somme_ns{ 0 };
+
+            void enregistrer(std::int64_t duree_ns) {
+                const std::uint64_t ns = duree_ns > 0 ? static_cast<std::uint64_t>(duree_ns) : 0;
+                ajouter(intervalles[intervalle(ns)], 1);
+                ajouter(somme_ns, ns);
+            }
+        };
+
+        // Compteurs d'un thread ; alignés sur une ligne de cache pour qu'aucun autre
+        // thread n'écrive à côté
+        struct alignas(64) CompteursThread {
+            std::array<Histogramme, MAX_ROUTES> routes;
+            std::array<std::array<Compteur, NOMBRE_STATUTS>, MAX_ROUTES> statuts{};
+            std::array<Histogramme, NOMBRE_ETAPES> etapes;
+        };
+
+        // Blocs de tous les threads ; jamais libérés, pour que les compteurs d'un thread
+        // terminé restent dans les totaux (des compteurs Prometheus ne décroissent pas)
+        struct Registre {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<CompteursThread>> blocs;
+        };
+
+        // Jamais détruit : des threads peuvent encore enregistrer pendant l'arrêt
+        Registre& registre() {
+            static Registre* instance = new Registre;
+            return *instance;
+        }
+
+        CompteursThread& compteursThread() {
+            thread_local CompteursThread* local = nullptr;
+            if (!local) {
+                auto bloc = std::make_unique<CompteursThread>();
+                local = bloc.get();
+                Registre& r = registre();
+                std::lock_guard<std::mutex> verrou(r.mutex);
+                r.blocs.push_back(std::move(bloc));
+            }
+            return *local;
+        }
+
+        // Somme des blocs, pour l'export
+        struct Totaux {
+            std::array<std::uint64_t, INTERVALLES> intervalles{};
+            std::uint64_t somme_ns = 0;
+
+            void ajouter(const Histogramme& h) {
+                for (std::size_t i = 0; i < INTERVALLES; ++i) {
+                    intervalles[i] += h.intervalles[i].load(std::memory_order_relaxed);
+                }
+                somme_ns += h.somme_ns.load(std::memory_order_relaxed);
+            }
+
+            std::uint64_t nombre() const {
+                std::uint64_t total = 0;
+                for (std::uint64_t n : intervalles) {
+                    total += n;
+                }
+                return total;
+            }
+        };
+
+        void ajouterNombre(std::string& sortie, double valeur) {
+            char tampon[32];
+            int n = std::snprintf(tampon, sizeof(tampon), "%.6g", valeur);
+            sortie.append(tampon, static_cast<std::size_t>(n));
+        }
+
+        // Valeur d'étiquette échappée (barre oblique inverse, guillemet, saut de ligne)
+        void ajouterEtiquette(std::string& sortie, std::string_view nom, std::string_view valeur) {
+            sortie.append(nom).append("=\"");
+            for (char c : valeur) {
+                if (c == '\\' || c == '"') {
+                    sortie.push_back('\\');
+                    sortie.push_back(c);
+                }
+                else if (c == '\n') {
+                    sortie.append("\\n");
+                }
+                else {
+                    sortie.push_back(c);
+                }
+            }
+            sortie.push_back('"');
+        }
+
+        // Lignes _bucket, _sum et _count d'une série ; etiquettes : "a=\"x\",b=\"y\""
+        void exporterHistogramme(std::string& sortie, std::string_view nom, const std::string& etiquettes, const Totaux& totaux) {
+            std::uint64_t cumul = 0;
+            for (std::size_t i = 0; i < INTERVALLES; ++i) {
+                cumul += totaux.intervalles[i];
+                sortie.append(nom).append("_bucket{").append(etiquettes).append(",le=\"");
+                if (i + 1 < INTERVALLES) {
+                    ajouterNombre(sortie, static_cast<double>(borne(i)) * 1e-9);
+                }
+                else {
+                    sortie.append("+Inf");
+                }
+                sortie.append("\"} ").append(std::to_string(cumul)).push_back('\n');
+            }
+            sortie.append(nom).append("_sum{").append(etiquettes).append("} ");
+            ajouterNombre(sortie, static_cast<double>(totaux.somme_ns) * 1e-9);
+            sortie.push_back('\n');
+            sortie.append(nom).append("_count{").append(etiquettes).append("} ").append(std::to_string(cumul)).push_back('\n');
+        }
+    }
+
+    void enregistrerRequete(std::uint16_t route, int statut, std::int64_t duree_ns) {
+        CompteursThread& compteurs = compteursThread();
+        const std::size_t r = route < MAX_ROUTES ? route : 0;
+        compteurs.routes[r].enregistrer(duree_ns);
+        ajouter(compteurs.statuts[r][indiceStatut(statut)], 1);
+    }
+
+    void enregistrerEtape(Etape etape, std::int64_t duree_ns) {
+        compteursThread().etapes[static_cast<std::size_t>(etape)].enregistrer(duree_ns);
+    }
+
+    std::string exporter(std::initializer_list<CompteurExterne> externes) {
+        std::array<Totaux, MAX_ROUTES> routes{};
+        std::array<std::array<std::uint64_t, NOMBRE_STATUTS>, MAX_ROUTES> statuts{};
+        std::array<Totaux, NOMBRE_ETAPES> etapes{};
+        {
+            Registre& r = registre();
+            std::lock_guard<std::mutex> verrou(r.mutex);
+            for (const auto& bloc : r.blocs) {
+                for (std::size_t i = 0; i < MAX_ROUTES; ++i) {
+                    routes[i].ajouter(bloc->routes[i]);
+                    for (std::size_t s = 0; s < NOMBRE_STATUTS; ++s) {
+                        statuts[i][s] += bloc->statuts[i][s].load(std::memory_order_relaxed);
+                    }
+                }
+                for (std::size_t e = 0; e < NOMBRE_ETAPES; ++e) {
+                    etapes[e].ajouter(bloc->etapes[e]);
+                }
+            }
+        }
+
+        // Étiquettes route et method de chaque route déclarée (0 : route non déclarée)
+        const PolitiquesAcces& table = politiquesAcces();
+        const std::size_t nombre_routes = std::min(table.nombreRoutes() + 1, MAX_ROUTES);
+        std::vector<std::string> etiquettes(nombre_routes);
+        for (std::size_t i = 0; i < nombre_routes; ++i) {
+            const auto id = static_cast<std::uint16_t>(i);
+            ajouterEtiquette(etiquettes[i], "route", i == 0 ? "(inconnue)" : table.gabarit(id));
+            etiquettes[i].push_back(',');
+            ajouterEtiquette(etiquettes[i], "method", i == 0 ? "*" : crow::method_name(table.methode(id)));
+        }
+
+        std::string sortie;
+        sortie.reserve(64 * 1024);
+
+        sortie.append("# HELP crowjourney_http_requests_total Requêtes HTTP traitées, par route, méthode et statut\n"
+            "# TYPE crowjourney_http_requests_total counter\n");
+        for (std::size_t i = 0; i < nombre_routes; ++i) {
+            for (std::size_t s = 0; s < NOMBRE_STATUTS; ++s) {
+                if (statuts[i][s] == 0) {
+                    continue;
+                }
+                std::string statut = s < STATUTS.size() ? std::to_string(STATUTS[s])
+                    : std::to_string(s - STATUTS.size() + 1) + "xx";
+                sortie.append("crowjourney_http_requests_total{").append(etiquettes[i]).push_back(',');
+                ajouterEtiquette(sortie, "status", statut);
+                sortie.append("} ").append(std::to_string(statuts[i][s])).push_back('\n');
+            }
+        }
+
+        sortie.append("# HELP crowjourney_http_request_duration_seconds Durée des requêtes HTTP, de la réception à la fin de la réponse\n"
+            "# TYPE crowjourney_http_request_duration_seconds histogram\n");
+        for (std::size_t i = 0; i < nombre_routes; ++i) {
+            if (routes[i].nombre() > 0) {
+                exporterHistogramme(sortie, "crowjourney_http_request_duration_seconds", etiquettes[i], routes[i]);
+            }
+        }
+
+        sortie.append("# HELP crowjourney_stage_duration_seconds Durée des étapes internes du traitement des requêtes\n"
+            "# TYPE crowjourney_stage_duration_seconds histogram\n");
+        for (std::size_t e = 0; e < NOMBRE_ETAPES; ++e) {
+            std::string etiquette;
+            ajouterEtiquette(etiquette, "stage", NOMS_ETAPES[e]);
+            exporterHistogramme(sortie, "crowjourney_stage_duration_seconds", etiquette, etapes[e]);
+        }
+
+        for (const CompteurExterne& compteur : externes) {
+            sortie.append("# HELP ").append(compteur.nom).push_back(' ');
+            sortie.append(compteur.aide).push_back('\n');
+            sortie.append("# TYPE ").append(compteur.nom).append(" counter\n");
+            sortie.append(compteur.nom).push_back(' ');
+            sortie.append(std::to_string(compteur.valeur)).push_back('\n');
+        }
+        return sortie;
+    }
+
+} // namespace crowjourney::metriques
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace crowjourney::metriques {
+
+    // Métriques du serveur au format texte de Prometheus (GET /metrics) :
+    //   - requêtes par route (gabarit déclaré avec ROUTE_ACCES), méthode et statut ;
+    //   - histogrammes de durée par route, et par étape interne (Etape).
+    //
+    // Chaque thread enregistre dans son propre bloc de compteurs, aligné sur une ligne de
+    // cache et jamais partagé en écriture : un enregistrement est quelques additions sans
+    // verrou ni instruction atomique read-modify-write. L'export additionne les blocs.
+    // Les histogrammes sont à la manière de HDR : quatre intervalles par puissance de deux,
+    // de 1 µs à 68 s (erreur relative au plus 25 %).
+
+    enum class Etape : std::uint8_t {
+        VerificationJwt,
+        AnalyseJson,
+        Serialisation,
+        VidageJournal,       // Écriture et fsync d'un lot du journal
+        EcritureInstantane,  // Instantané binaire écrit par une compaction
+        Nombre
+    };
+
+    // Horloge monotone, en nanosecondes
+    inline std::int64_t maintenant() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // route : numéro de PolitiquesAcces::Route (0 pour une route non déclarée)
+    void enregistrerRequete(std::uint16_t route, int statut, std::int64_t duree_ns);
+
+    void enregistrerEtape(Etape etape, std::int64_t duree_ns);
+
+    // Mesure la durée d'une étape, de sa construction à sa destruction
+    class Chrono {
+    public:
+        explicit Chrono(Etape etape) : etape_(etape), debut_(maintenant()) {}
+        ~Chrono() { enregistrerEtape(etape_, maintenant() - debut_); }
+
+        Chrono(const Chrono&) = delete;
+        Chrono& operator=(const Chrono&) = delete;
+
+    private:
+        Etape etape_;
+        std::int64_t debut_;
+    };
+
+    // Compteur tenu ailleurs (cache des jetons...), ajouté tel quel à l'export
+    struct CompteurExterne {
+        std::string_view nom;
+        std::string_view aide;
+        std::uint64_t valeur;
+    };
+
+    // Toutes les séries, au format d'exposition texte 0.0.4, suivies des compteurs externes
+    std::string exporter(std::initializer_list<CompteurExterne> externes = {});
+
+} // namespace crowjourney::metriques
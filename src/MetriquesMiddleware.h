@@ -0,0 +1,28 @@
+#pragma once
+#include <crow.h>
+#include "Metriques.h"
+#include "PolitiquesAcces.h"
+
+namespace crowjourney {
+
+    // Mesure la durée de chaque requête, comptée avec la route reconnue par
+    // RoutageMiddleware (qui doit le précéder dans l'application). Crow appelle
+    // after_handle même quand un middleware suivant termine la réponse, et, pour un
+    // handler asynchrone, seulement au res.end() du handler.
+    class MetriquesMiddleware {
+    public:
+        struct context {
+            std::int64_t debut = 0;
+        };
+
+        void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+            ctx.debut = metriques::maintenant();
+        }
+
+        template <typename AllContext>
+        void after_handle(crow::request& /*req*/, crow::response& res, context& ctx, AllContext& contextes) {
+            metriques::enregistrerRequete(contextes.template get<RoutageMiddleware>().route.id,
+                res.code, metriques::maintenant() - ctx.debut);
+        }
+    };
+}
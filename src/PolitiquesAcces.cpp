@@ -0,0 +1,77 @@
+#include "PolitiquesAcces.h"
+#include <stdexcept>
+
+namespace crowjourney {
+
+    namespace {
+        // Segment que Crow accepte pour un paramètre <int> (signe facultatif, chiffres)
+        bool entier(std::string_view segment) {
+            if (!segment.empty() && (segment.front() == '-' || segment.front() == '+')) {
+                segment.remove_prefix(1);
+            }
+            if (segment.empty()) {
+                return false;
+            }
+            for (char c : segment) {
+                if (c < '0' || c > '9') {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Méthode sur un octet, puis l'URL avec chaque segment entier remplacé par <int>
+        void construireCle(crow::HTTPMethod methode, std::string_view url, std::string& cle) {
+            cle.clear();
+            cle.push_back(static_cast<char>(methode));
+            while (!url.empty()) {
+                std::size_t barre = url.find('/', 1);
+                std::string_view segment = url.substr(0, barre);
+                if (segment.size() > 1 && entier(segment.substr(1))) {
+                    cle.append("/<int>");
+                }
+                else {
+                    cle.append(segment);
+                }
+                url = barre == std::string_view::npos ? std::string_view() : url.substr(barre);
+            }
+        }
+    }
+
+    PolitiquesAcces::PolitiquesAcces() {
+        routes_.emplace_back(crow::HTTPMethod::GET, std::string()); // 0 : route non déclarée
+    }
+
+    void PolitiquesAcces::declarer(crow::HTTPMethod methode, std::string_view gabarit, PolitiqueAcces politique) {
+        for (std::size_t i = gabarit.find('<'); i != std::string_view::npos; i = gabarit.find('<', i + 1)) {
+            if (gabarit.substr(i, 5) != "<int>") {
+                throw std::invalid_argument("Paramètre de route non pris en charge par les politiques d'accès: " + std::string(gabarit));
+            }
+        }
+        std::string cle;
+        construireCle(methode, gabarit, cle);
+        auto [it, nouvelle] = table_.try_emplace(std::move(cle));
+        if (nouvelle) {
+            it->second.id = static_cast<std::uint16_t>(routes_.size());
+            routes_.emplace_back(methode, std::string(gabarit));
+        }
+        it->second.politique = politique;
+    }
+
+    PolitiquesAcces::Route PolitiquesAcces::route(crow::HTTPMethod methode, std::string_view url) const {
+        // Crow sert HEAD par la route GET correspondante : même politique, même étiquette
+        if (methode == crow::HTTPMethod::HEAD) {
+            methode = crow::HTTPMethod::GET;
+        }
+        thread_local std::string cle; // Capacité réutilisée d'une requête à l'autre
+        construireCle(methode, url, cle);
+        auto it = table_.find(cle);
+        return it == table_.end() ? Route{} : it->second;
+    }
+
+    PolitiquesAcces& politiquesAcces() {
+        static PolitiquesAcces instance;
+        return instance;
+    }
+
+} // namespace crowjourney
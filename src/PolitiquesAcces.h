@@ -0,0 +1,87 @@
+#pragma once
+
+#include <crow.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "User.h"
+
+namespace crowjourney {
+
+    // Politique d'accès d'une route : masque des rôles admis (bits de RoleUser),
+    // 0 pour une route publique
+    using PolitiqueAcces = std::uint8_t;
+
+    constexpr PolitiqueAcces ACCES_PUBLIC = 0;
+    constexpr PolitiqueAcces ACCES_AUTHENTIFIE = ROLE_USER | ROLE_ADMIN;
+    constexpr PolitiqueAcces ACCES_ADMIN = ROLE_ADMIN;
+
+    // Table des routes et de leurs politiques, remplie à l'enregistrement (ROUTE_ACCES) et
+    // lue une fois par requête par RoutageMiddleware. Crow n'indique pas aux middlewares
+    // globaux quelle règle a été retenue : la clé est la méthode et le gabarit de la route,
+    // et l'URL de la requête est ramenée à ce gabarit (segments numériques -> <int>) avant
+    // une seule recherche.
+    //
+    // La table n'est modifiée qu'au démarrage, avant app.run() ; les lectures des threads
+    // de requête se font donc sans verrou. Une route absente de la table exige un jeton.
+    class PolitiquesAcces {
+    public:
+        // Route reconnue : sa politique et un numéro stable (0 : route non déclarée),
+        // qui sert d'étiquette aux métriques
+        struct Route {
+            PolitiqueAcces politique = ACCES_AUTHENTIFIE;
+            std::uint16_t id = 0;
+        };
+
+        PolitiquesAcces();
+
+        // Seuls les paramètres <int> sont pris en charge dans le gabarit
+        void declarer(crow::HTTPMethod methode, std::string_view gabarit, PolitiqueAcces politique);
+
+        Route route(crow::HTTPMethod methode, std::string_view url) const;
+
+        PolitiqueAcces politique(crow::HTTPMethod methode, std::string_view url) const {
+            return route(methode, url).politique;
+        }
+
+        // Routes déclarées, numérotées de 1 à nombreRoutes() ; le gabarit de 0 est vide
+        std::size_t nombreRoutes() const { return routes_.size() - 1; }
+        crow::HTTPMethod methode(std::uint16_t id) const { return routes_[id].first; }
+        std::string_view gabarit(std::uint16_t id) const { return routes_[id].second; }
+
+    private:
+        std::unordered_map<std::string, Route> table_;
+        std::vector<std::pair<crow::HTTPMethod, std::string>> routes_;
+    };
+
+    PolitiquesAcces& politiquesAcces();
+
+    // Premier middleware de l'application : reconnaît la route une fois pour toute la
+    // requête. Les middlewares suivants lisent son contexte : JWTAuthMiddleware pour la
+    // politique d'accès, MetriquesMiddleware pour l'étiquette de la route.
+    class RoutageMiddleware {
+    public:
+        struct context {
+            PolitiquesAcces::Route route;
+        };
+
+        void before_handle(crow::request& req, crow::response& /*res*/, context& ctx) {
+            ctx.route = politiquesAcces().route(req.method, req.url);
+        }
+
+        void after_handle(crow::request& /*req*/, crow::response& /*res*/, context& /*ctx*/) {
+        }
+    };
+
+} // namespace crowjourney
+
+// CROW_ROUTE(app, url).methods(methode), après avoir déclaré la politique de la route.
+// La déclaration a lieu à l'exécution, au démarrage : elle remplit la table de chaînes de
+// PolitiquesAcces, consultée à chaque requête ; rien n'est vérifié à la compilation.
+//   ROUTE_ACCES(app, "/books/<int>", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(getBookById);
+#define ROUTE_ACCES(app, url, methode, politique)                                      \
+    (::crowjourney::politiquesAcces().declarer(methode, url, politique),               \
+        CROW_ROUTE(app, url).methods(methode))
@@ -0,0 +1,67 @@
+#include "PoolCalcul.h"
+#include <algorithm>
+#include <exception>
+#include "Traces.h"
+
+namespace crowjourney {
+
+    PoolCalcul::PoolCalcul(std::size_t threads, std::size_t capacite)
+        : capacite_(std::max<std::size_t>(capacite, 1)) {
+        threads = std::max<std::size_t>(threads, 1);
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&PoolCalcul::boucle, this);
+        }
+    }
+
+    PoolCalcul::~PoolCalcul() {
+        {
+            std::lock_guard<std::mutex> verrou(mutex_);
+            arret_ = true;
+        }
+        tache_cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    bool PoolCalcul::soumettre(std::function<void()> tache) {
+        {
+            std::lock_guard<std::mutex> verrou(mutex_);
+            if (arret_ || file_.size() >= capacite_) {
+                return false;
+            }
+            file_.push_back(std::move(tache));
+        }
+        tache_cv_.notify_one();
+        return true;
+    }
+
+    std::size_t PoolCalcul::enAttente() const {
+        std::lock_guard<std::mutex> verrou(mutex_);
+        return file_.size();
+    }
+
+    void PoolCalcul::boucle() {
+        std::unique_lock<std::mutex> verrou(mutex_);
+        while (true) {
+            tache_cv_.wait(verrou, [this]() { return arret_ || !file_.empty(); });
+            if (file_.empty()) {
+                return; // Arrêt demandé et plus rien à exécuter
+            }
+            std::function<void()> tache = std::move(file_.front());
+            file_.pop_front();
+            verrou.unlock();
+
+            // Une tâche qui échoue ne doit pas emporter le thread (ni le processus)
+            try {
+                tache();
+            }
+            catch (const std::exception& e) {
+                TRACE_ERREUR("Erreur dans une tâche du pool de calcul", traces::champ("erreur", e.what()));
+            }
+            verrou.lock();
+        }
+    }
+
+} // namespace crowjourney
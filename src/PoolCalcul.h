@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace crowjourney {
+
+    // Pool de threads réservé aux calculs coûteux (dérivation des mots de passe), pour
+    // qu'ils n'occupent pas les threads d'E/S de Crow qui servent les autres requêtes.
+    //
+    // La file d'attente est bornée : quand `capacite` tâches attendent déjà,
+    // soumettre() refuse la nouvelle tâche au lieu de la mettre en file, et l'appelant
+    // répond immédiatement (503) plutôt que de laisser la latence croître sans limite.
+    class PoolCalcul {
+    public:
+        PoolCalcul(std::size_t threads, std::size_t capacite);
+
+        // Exécute les tâches déjà acceptées puis arrête les threads
+        ~PoolCalcul();
+
+        PoolCalcul(const PoolCalcul&) = delete;
+        PoolCalcul& operator=(const PoolCalcul&) = delete;
+
+        // Mettre une tâche en file ; false si la file est pleine (la tâche n'est pas exécutée)
+        bool soumettre(std::function<void()> tache);
+
+        std::size_t enAttente() const;
+        std::size_t capacite() const { return capacite_; }
+        std::size_t threads() const { return threads_.size(); }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable tache_cv_;
+        std::deque<std::function<void()>> file_;
+        std::size_t capacite_;
+        bool arret_ = false;
+        std::vector<std::thread> threads_;
+
+        void boucle();
+    };
+
+} // namespace crowjourney
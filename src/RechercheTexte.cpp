@@ -0,0 +1,309 @@
+#include "RechercheTexte.h"
+#include "library.h"
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <queue>
+
+namespace crowjourney {
+
+    namespace {
+        // Paramètres BM25 usuels
+        constexpr double BM25_K1 = 1.2;
+        constexpr double BM25_B = 0.75;
+
+        // Au-delà, les termes d'une requête sont ignorés
+        constexpr std::size_t TERMES_REQUETE_MAX = 16;
+
+        // Mots vides du français (forme normalisée, triés) : trop fréquents pour départager
+        // les livres, ils allongeraient les listes parcourues sans améliorer le classement
+        constexpr std::string_view MOTS_VIDES[] = {
+            "au", "aux", "avec", "ce", "ces", "dans", "de", "des", "du", "en", "et", "il", "la", "le",
+            "les", "leur", "ne", "ou", "par", "pas", "pour", "qu", "que", "qui", "sa", "se", "ses",
+            "son", "sur", "un", "une"
+        };
+
+        bool motVide(std::string_view mot) {
+            return std::binary_search(std::begin(MOTS_VIDES), std::end(MOTS_VIDES), mot);
+        }
+
+        // Mots indexables d'un texte : mots vides retirés
+        std::vector<std::string> motsIndexables(std::string_view texte) {
+            std::vector<std::string> mots = extraireMots(texte);
+            mots.erase(std::remove_if(mots.begin(), mots.end(), [](const std::string& mot) { return motVide(mot); }), mots.end());
+            return mots;
+        }
+
+        // Équivalents sans accent de U+00C0 à U+00FF ; nullptr pour × et ÷ (séparateurs)
+        constexpr const char* LATIN1[64] = {
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "ss",
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+            "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "y"
+        };
+
+        // Décoder le point de code commençant à i ; renvoie sa longueur, 0 si la séquence est invalide
+        std::size_t decoderUtf8(std::string_view texte, std::size_t i, std::uint32_t& point) {
+            const unsigned char c = static_cast<unsigned char>(texte[i]);
+            std::size_t n;
+            if (c >= 0xC2 && c <= 0xDF) { n = 2; point = c & 0x1F; }
+            else if (c >= 0xE0 && c <= 0xEF) { n = 3; point = c & 0x0F; }
+            else if (c >= 0xF0 && c <= 0xF4) { n = 4; point = c & 0x07; }
+            else return 0;
+
+            if (i + n > texte.size()) return 0;
+            for (std::size_t k = 1; k < n; ++k) {
+                const unsigned char suite = static_cast<unsigned char>(texte[i + k]);
+                if ((suite & 0xC0) != 0x80) return 0;
+                point = (point << 6) | (suite & 0x3F);
+            }
+            if ((n == 3 && point < 0x800) || (n == 4 && (point < 0x10000 || point > 0x10FFFF))
+                || (point >= 0xD800 && point <= 0xDFFF)) {
+                return 0;
+            }
+            return n;
+        }
+
+        // Fréquence de chaque terme d'un livre, et nombre total de mots
+        std::vector<std::pair<std::string, std::uint32_t>> termesDuLivre(const Livre& livre, std::uint32_t& longueur) {
+            std::vector<std::string> mots = motsIndexables(livre.titre);
+            std::vector<std::string> mots_auteur = motsIndexables(livre.auteur);
+            mots.insert(mots.end(), std::make_move_iterator(mots_auteur.begin()), std::make_move_iterator(mots_auteur.end()));
+            longueur = static_cast<std::uint32_t>(mots.size());
+
+            std::sort(mots.begin(), mots.end());
+            std::vector<std::pair<std::string, std::uint32_t>> termes;
+            for (auto& mot : mots) {
+                if (!termes.empty() && termes.back().first == mot) {
+                    ++termes.back().second;
+                }
+                else {
+                    termes.emplace_back(std::move(mot), 1);
+                }
+            }
+            return termes;
+        }
+    }
+
+    std::vector<std::string> extraireMots(std::string_view texte, std::size_t longueur_min) {
+        std::vector<std::string> mots;
+        std::string mot;
+        std::size_t caracteres = 0;
+        auto couper = [&]() {
+            if (caracteres >= longueur_min && caracteres > 0) {
+                mots.push_back(std::move(mot));
+            }
+            mot.clear();
+            caracteres = 0;
+        };
+
+        std::size_t i = 0;
+        while (i < texte.size()) {
+            const unsigned char c = static_cast<unsigned char>(texte[i]);
+            if (c < 0x80) {
+                if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+                    mot.push_back(static_cast<char>(c));
+                    ++caracteres;
+                }
+                else if (c >= 'A' && c <= 'Z') {
+                    mot.push_back(static_cast<char>(c - 'A' + 'a'));
+                    ++caracteres;
+                }
+                else {
+                    couper();
+                }
+                ++i;
+                continue;
+            }
+
+            std::uint32_t point = 0;
+            std::size_t n = decoderUtf8(texte, i, point);
+            if (n == 0) {
+                couper();
+                ++i;
+                continue;
+            }
+            if (point >= 0xC0 && point <= 0xFF && LATIN1[point - 0xC0]) {
+                mot.append(LATIN1[point - 0xC0]);
+                ++caracteres;
+            }
+            else if (point == 0x152 || point == 0x153) {
+                mot.append("oe"); // Œ, œ
+                ++caracteres;
+            }
+            else if (point == 0x178) {
+                mot.push_back('y'); // Ÿ
+                ++caracteres;
+            }
+            else if (point <= 0xFF || (point >= 0x2000 && point <= 0x206F) || (point >= 0x3000 && point <= 0x303F)) {
+                couper(); // Ponctuation latine (« », espace insécable), ponctuation générale (’, —)
+            }
+            else {
+                mot.append(texte.substr(i, n)); // Autres écritures : conservées telles quelles
+                ++caracteres;
+            }
+            i += n;
+        }
+        couper();
+        return mots;
+    }
+
+    void RechercheTexte::ajouter(const Livre& livre) {
+        if (livre.id < 0) {
+            return;
+        }
+        std::uint32_t longueur = 0;
+        for (auto& [terme, frequence] : termesDuLivre(livre, longueur)) {
+            auto& occurrences = termes_[terme];
+            // Les nouveaux livres ont l'id le plus grand : l'ajout se fait presque toujours en fin
+            auto pos = std::lower_bound(occurrences.begin(), occurrences.end(), livre.id,
+                [](const Occurrence& o, int id) { return o.id < id; });
+            if (pos != occurrences.end() && pos->id == livre.id) {
+                pos->frequence = frequence;
+            }
+            else {
+                occurrences.insert(pos, Occurrence{ livre.id, frequence });
+            }
+        }
+
+        const std::size_t indice = static_cast<std::size_t>(livre.id);
+        if (indice >= longueurs_.size()) {
+            longueurs_.resize(indice + 1, 0);
+        }
+        if (longueurs_[indice] == 0 && longueur > 0) {
+            ++documents_;
+        }
+        else if (longueurs_[indice] > 0 && longueur == 0) {
+            --documents_;
+        }
+        longueur_totale_ = longueur_totale_ - longueurs_[indice] + longueur;
+        longueurs_[indice] = longueur;
+    }
+
+    void RechercheTexte::retirer(const Livre& livre) {
+        if (livre.id < 0) {
+            return;
+        }
+        std::uint32_t longueur = 0;
+        for (const auto& [terme, frequence] : termesDuLivre(livre, longueur)) {
+            auto it = termes_.find(terme);
+            if (it == termes_.end()) {
+                continue;
+            }
+            auto& occurrences = it->second;
+            auto pos = std::lower_bound(occurrences.begin(), occurrences.end(), livre.id,
+                [](const Occurrence& o, int id) { return o.id < id; });
+            if (pos != occurrences.end() && pos->id == livre.id) {
+                occurrences.erase(pos);
+            }
+            if (occurrences.empty()) {
+                termes_.erase(it);
+            }
+        }
+
+        const std::size_t indice = static_cast<std::size_t>(livre.id);
+        if (indice < longueurs_.size() && longueurs_[indice] > 0) {
+            longueur_totale_ -= longueurs_[indice];
+            longueurs_[indice] = 0;
+            --documents_;
+        }
+    }
+
+    void RechercheTexte::remplacer(const Livre* avant, const Livre* apres) {
+        if (avant && apres && avant->id == apres->id
+            && avant->titre == apres->titre && avant->auteur == apres->auteur) {
+            return; // Aucun champ indexé n'a changé
+        }
+        if (avant) {
+            retirer(*avant);
+        }
+        if (apres) {
+            ajouter(*apres);
+        }
+    }
+
+    void RechercheTexte::vider() {
+        termes_.clear();
+        longueurs_.clear();
+        documents_ = 0;
+        longueur_totale_ = 0;
+    }
+
+    std::vector<RechercheTexte::Resultat> RechercheTexte::rechercher(std::string_view requete, std::size_t limite) const {
+        std::vector<std::string> mots = motsIndexables(requete);
+        std::sort(mots.begin(), mots.end());
+        mots.erase(std::unique(mots.begin(), mots.end()), mots.end());
+        if (mots.size() > TERMES_REQUETE_MAX) {
+            mots.resize(TERMES_REQUETE_MAX);
+        }
+
+        // Listes des termes présents, avec leur IDF
+        struct Curseur {
+            const std::vector<Occurrence>* occurrences;
+            std::size_t position;
+            double idf;
+        };
+        std::vector<Curseur> curseurs;
+        for (const auto& mot : mots) {
+            auto it = termes_.find(mot);
+            if (it != termes_.end()) {
+                const double df = static_cast<double>(it->second.size());
+                const double idf = std::log(1.0 + (static_cast<double>(documents_) - df + 0.5) / (df + 0.5));
+                curseurs.push_back({ &it->second, 0, idf });
+            }
+        }
+        if (curseurs.empty() || limite == 0) {
+            return {};
+        }
+
+        // Fusion des listes par id croissant ; les limite meilleurs scores sont gardés
+        // dans un tas dont la racine est le plus faible
+        const double longueur_moyenne = static_cast<double>(longueur_totale_) / static_cast<double>(documents_);
+        auto meilleur = [](const Resultat& a, const Resultat& b) {
+            return a.score > b.score || (a.score == b.score && a.id < b.id);
+        };
+        std::priority_queue<Resultat, std::vector<Resultat>, decltype(meilleur)> meilleurs(meilleur);
+
+        while (true) {
+            int id = -1;
+            for (const auto& curseur : curseurs) {
+                if (curseur.position < curseur.occurrences->size()) {
+                    int candidat = (*curseur.occurrences)[curseur.position].id;
+                    if (id < 0 || candidat < id) {
+                        id = candidat;
+                    }
+                }
+            }
+            if (id < 0) {
+                break;
+            }
+
+            const double normalisation = BM25_K1 * (1.0 - BM25_B + BM25_B * longueurs_[static_cast<std::size_t>(id)] / longueur_moyenne);
+            double score = 0.0;
+            for (auto& curseur : curseurs) {
+                if (curseur.position < curseur.occurrences->size() && (*curseur.occurrences)[curseur.position].id == id) {
+                    const double tf = (*curseur.occurrences)[curseur.position].frequence;
+                    score += curseur.idf * tf * (BM25_K1 + 1.0) / (tf + normalisation);
+                    ++curseur.position;
+                }
+            }
+
+            Resultat resultat{ id, score };
+            if (meilleurs.size() < limite) {
+                meilleurs.push(resultat);
+            }
+            else if (meilleur(resultat, meilleurs.top())) {
+                meilleurs.pop();
+                meilleurs.push(resultat);
+            }
+        }
+
+        std::vector<Resultat> resultats(meilleurs.size());
+        for (std::size_t i = resultats.size(); i-- > 0;) {
+            resultats[i] = meilleurs.top();
+            meilleurs.pop();
+        }
+        return resultats;
+    }
+
+} // namespace crowjourney
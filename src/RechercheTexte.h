@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Livre;
+
+namespace crowjourney {
+
+    // Découper un texte UTF-8 en mots normalisés : minuscules, accents retirés
+    // (é → e, ç → c, œ → oe...), séparés par tout ce qui n'est ni lettre ni chiffre.
+    // Les mots de moins de longueur_min caractères (l', d'... par défaut) sont ignorés.
+    std::vector<std::string> extraireMots(std::string_view texte, std::size_t longueur_min = 2);
+
+    // Index inversé plein texte sur le titre et l'auteur des livres, classement BM25.
+    // Les mots vides du français (le, la, de...) ne sont pas indexés.
+    //
+    // Chaque terme associe la liste triée par id des livres qui le contiennent, avec sa
+    // fréquence. Comme IndexLivres, la structure n'est pas synchronisée : le gestionnaire
+    // la modifie et la lit sous son verrou d'index.
+    class RechercheTexte {
+    public:
+        struct Resultat {
+            int id;
+            double score;
+        };
+
+        void ajouter(const Livre& livre);
+        void retirer(const Livre& livre);
+
+        // Remplacer l'état indexé d'un livre (avant ou apres peut être nul)
+        void remplacer(const Livre* avant, const Livre* apres);
+
+        void vider();
+
+        // Les limite meilleurs livres pour la requête (un livre doit contenir au moins
+        // un des termes), par score décroissant
+        std::vector<Resultat> rechercher(std::string_view requete, std::size_t limite) const;
+
+    private:
+        struct Occurrence {
+            int id;
+            std::uint32_t frequence;
+        };
+
+        std::unordered_map<std::string, std::vector<Occurrence>> termes_;
+        std::vector<std::uint32_t> longueurs_; // Nombre de mots par id, 0 si non indexé
+        std::size_t documents_ = 0;
+        std::uint64_t longueur_totale_ = 0;
+    };
+
+} // namespace crowjourney
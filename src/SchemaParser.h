@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <nlohmann/json.hpp>
+#include "Metriques.h"
+
+namespace crowjourney {
+
+    // Erreur de validation d'un corps de requête ; le message est destiné au client
+    class ErreurSchema : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Description d'un champ attendu dans un objet JSON plat, et du membre de T à remplir
+    template <typename T>
+    struct ChampSchema {
+        std::string_view nom;
+        std::variant<std::optional<std::string> T::*, std::optional<int> T::*> cible;
+        std::size_t longueur_max = 256; // Octets, pour les chaînes
+    };
+
+    // Analyse en une passe (SAX) d'un objet JSON plat vers une structure typée, sans DOM.
+    // L'analyse s'arrête dès la première anomalie : champ inconnu ou en double, type
+    // inattendu, chaîne trop longue, valeur imbriquée ou JSON mal formé.
+    template <typename T, std::size_t N>
+    class AnalyseurSchema {
+    public:
+        using json = nlohmann::json;
+
+        explicit AnalyseurSchema(const std::array<ChampSchema<T>, N>& schema) : schema_(schema) {}
+
+        T analyser(std::string_view corps, std::size_t taille_max = 16 * 1024) {
+            if (corps.size() > taille_max) {
+                throw ErreurSchema("Corps de requête trop volumineux (" + std::to_string(taille_max) + " octets maximum)");
+            }
+            if (!json::sax_parse(corps.begin(), corps.end(), this)) {
+                throw ErreurSchema(erreur_.empty() ? std::string("JSON invalide") : erreur_);
+            }
+            return std::move(resultat_);
+        }
+
+        // Interface SAX de nlohmann::json
+        bool null() { return valeurInvalide("null"); }
+        bool boolean(bool) { return valeurInvalide("un booléen"); }
+        bool number_float(json::number_float_t, const json::string_t&) { return entier(std::nullopt); }
+        bool number_integer(json::number_integer_t valeur) { return entier(valeur); }
+        bool number_unsigned(json::number_unsigned_t valeur) {
+            return entier(valeur > static_cast<json::number_unsigned_t>(std::numeric_limits<std::int64_t>::max())
+                ? std::nullopt : std::optional<std::int64_t>(static_cast<std::int64_t>(valeur)));
+        }
+        bool binary(json::binary_t&) { return valeurInvalide("une valeur binaire"); }
+
+        bool string(json::string_t& valeur) {
+            if (profondeur_ == 0) {
+                return echec("Le corps de la requête doit être un objet JSON");
+            }
+            auto* cible = std::get_if<std::optional<std::string> T::*>(&courant_->cible);
+            if (!cible) {
+                return echec("Le champ '" + std::string(courant_->nom) + "' doit être un entier");
+            }
+            if (valeur.size() > courant_->longueur_max) {
+                return echec("Le champ '" + std::string(courant_->nom) + "' dépasse "
+                    + std::to_string(courant_->longueur_max) + " octets");
+            }
+            resultat_.*(*cible) = std::move(valeur);
+            courant_ = nullptr;
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            if (profondeur_ != 0) {
+                return valeurInvalide("un objet");
+            }
+            ++profondeur_;
+            return true;
+        }
+
+        bool key(json::string_t& nom) {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (schema_[i].nom == nom) {
+                    if (vus_[i]) {
+                        return echec("Champ en double: '" + nom + "'");
+                    }
+                    vus_[i] = true;
+                    courant_ = &schema_[i];
+                    return true;
+                }
+            }
+            return echec("Champ inconnu: '" + nom.substr(0, 64) + "'");
+        }
+
+        bool end_object() {
+            --profondeur_;
+            return true;
+        }
+
+        bool start_array(std::size_t) { return valeurInvalide("un tableau"); }
+        bool end_array() { return true; }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) {
+            if (erreur_.empty()) {
+                erreur_ = "JSON invalide à la position " + std::to_string(position);
+            }
+            return false;
+        }
+
+    private:
+        const std::array<ChampSchema<T>, N>& schema_;
+        std::array<bool, N> vus_{};
+        const ChampSchema<T>* courant_ = nullptr;
+        int profondeur_ = 0;
+        T resultat_{};
+        std::string erreur_;
+
+        bool echec(std::string message) {
+            erreur_ = std::move(message);
+            return false;
+        }
+
+        bool valeurInvalide(const char* genre) {
+            if (profondeur_ == 0) {
+                return echec("Le corps de la requête doit être un objet JSON");
+            }
+            if (!courant_) {
+                return echec(std::string("Valeur inattendue: ") + genre);
+            }
+            return echec("Le champ '" + std::string(courant_->nom) + "' ne peut pas être " + genre);
+        }
+
+        bool entier(std::optional<std::int64_t> valeur) {
+            if (profondeur_ == 0) {
+                return echec("Le corps de la requête doit être un objet JSON");
+            }
+            auto* cible = std::get_if<std::optional<int> T::*>(&courant_->cible);
+            if (!cible) {
+                return echec("Le champ '" + std::string(courant_->nom) + "' doit être une chaîne");
+            }
+            if (!valeur || *valeur < std::numeric_limits<int>::min() || *valeur > std::numeric_limits<int>::max()) {
+                return echec("Le champ '" + std::string(courant_->nom) + "' doit être un entier 32 bits");
+            }
+            resultat_.*(*cible) = static_cast<int>(*valeur);
+            courant_ = nullptr;
+            return true;
+        }
+    };
+
+    // Analyser un corps de requête selon un schéma ; lève ErreurSchema en cas d'anomalie
+    template <typename T, std::size_t N>
+    T analyserCorps(std::string_view corps, const std::array<ChampSchema<T>, N>& schema) {
+        metriques::Chrono chrono(metriques::Etape::AnalyseJson);
+        AnalyseurSchema<T, N> analyseur(schema);
+        return analyseur.analyser(corps);
+    }
+
+} // namespace crowjourney
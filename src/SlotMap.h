@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace crowjourney {
+
+    // Slot map générationnel indexé directement par l'identifiant (0 <= id <= ID_MAX).
+    //
+    // Les cases sont regroupées en blocs, les blocs en répertoires, sous une racine :
+    // un arbre radix à deux niveaux au-dessus des blocs, dont les nœuds sont partagés
+    // entre les copies de la table. Copier une SlotMap ne copie que le pointeur de la
+    // racine ; une modification ne duplique que le chemin jusqu'au bloc touché (racine,
+    // répertoire, bloc : taille fixe, quel que soit le nombre d'éléments). Lecture, mise
+    // à jour et suppression sont en O(1), l'itération suit l'ordre croissant des ids.
+    template <typename T, std::size_t TailleBloc = 256>
+    class SlotMap {
+        static constexpr std::size_t TAILLE_REPERTOIRE = 256; // Blocs par répertoire
+        static constexpr std::size_t TAILLE_RACINE = 256;     // Répertoires sous la racine
+        static constexpr std::size_t NOMBRE_BLOCS = TAILLE_RACINE * TAILLE_REPERTOIRE;
+
+    public:
+        // Plus grand id accepté (16 777 215 avec des blocs de 256 cases)
+        static constexpr int ID_MAX = static_cast<int>(NOMBRE_BLOCS * TailleBloc - 1);
+
+        static constexpr bool idValide(int id) { return id >= 0 && id <= ID_MAX; }
+
+        // Clé stable : la génération change à chaque suppression de la case
+        struct Cle {
+            int id = -1;
+            std::uint32_t generation = 0;
+        };
+
+    private:
+        struct Case {
+            std::shared_ptr<const T> valeur;
+            std::uint32_t generation = 0;
+        };
+
+        struct Bloc {
+            std::array<Case, TailleBloc> cases;
+            std::size_t occupees = 0;
+        };
+
+        struct Repertoire {
+            std::array<std::shared_ptr<const Bloc>, TAILLE_REPERTOIRE> blocs;
+        };
+
+        struct Racine {
+            std::array<std::shared_ptr<const Repertoire>, TAILLE_RACINE> repertoires;
+        };
+
+        std::shared_ptr<const Racine> racine_;
+        std::size_t nombre_blocs_ = 0; // Un de plus que le plus grand indice de bloc alloué
+        std::size_t taille_ = 0;
+
+        static const Bloc* blocDe(const Racine* racine, std::size_t indice) {
+            const auto& repertoire = racine->repertoires[indice / TAILLE_REPERTOIRE];
+            return repertoire ? repertoire->blocs[indice % TAILLE_REPERTOIRE].get() : nullptr;
+        }
+
+        const Case* caseDe(int id) const {
+            if (!idValide(id)) return nullptr;
+            std::size_t indice = static_cast<std::size_t>(id) / TailleBloc;
+            if (indice >= nombre_blocs_) return nullptr;
+            const Bloc* bloc = blocDe(racine_.get(), indice);
+            return bloc ? &bloc->cases[static_cast<std::size_t>(id) % TailleBloc] : nullptr;
+        }
+
+        // Obtenir un nœud modifiable : il est dupliqué s'il est partagé avec une autre copie.
+        // Un nœud référencé une seule fois n'est visible que par cette instance, qui n'est
+        // pas encore publiée : il peut être modifié sur place. Dupliquer un parent partage
+        // ses enfants, qui sont donc dupliqués à leur tour le long du chemin.
+        template <typename Noeud>
+        static Noeud& modifiable(std::shared_ptr<const Noeud>& noeud) {
+            if (!noeud) {
+                noeud = std::make_shared<Noeud>();
+            }
+            else if (noeud.use_count() > 1) {
+                noeud = std::make_shared<Noeud>(*noeud);
+            }
+            return const_cast<Noeud&>(*noeud);
+        }
+
+        Bloc& blocModifiable(std::size_t indice) {
+            Racine& racine = modifiable(racine_);
+            Repertoire& repertoire = modifiable(racine.repertoires[indice / TAILLE_REPERTOIRE]);
+            if (indice >= nombre_blocs_) {
+                nombre_blocs_ = indice + 1;
+            }
+            return modifiable(repertoire.blocs[indice % TAILLE_REPERTOIRE]);
+        }
+
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator() = default;
+
+            reference operator*() const { return *caseCourante().valeur; }
+            pointer operator->() const { return caseCourante().valeur.get(); }
+            int id() const { return static_cast<int>(bloc_ * TailleBloc + case_); }
+
+            const_iterator& operator++() {
+                ++case_;
+                avancer();
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator copie = *this;
+                ++(*this);
+                return copie;
+            }
+
+            bool operator==(const const_iterator& autre) const {
+                return bloc_ == autre.bloc_ && case_ == autre.case_;
+            }
+            bool operator!=(const const_iterator& autre) const { return !(*this == autre); }
+
+        private:
+            friend class SlotMap;
+
+            const Racine* racine_ = nullptr;
+            std::size_t nombre_blocs_ = 0;
+            std::size_t bloc_ = 0;
+            std::size_t case_ = 0;
+
+            const_iterator(const Racine* racine, std::size_t nombre_blocs, std::size_t bloc, std::size_t c)
+                : racine_(racine), nombre_blocs_(nombre_blocs), bloc_(bloc), case_(c) {
+                avancer();
+            }
+
+            const Case& caseCourante() const { return blocDe(racine_, bloc_)->cases[case_]; }
+
+            // Se placer sur la prochaine case occupée en sautant les blocs et répertoires vides
+            void avancer() {
+                while (bloc_ < nombre_blocs_) {
+                    if (!racine_->repertoires[bloc_ / TAILLE_REPERTOIRE]) {
+                        bloc_ = (bloc_ / TAILLE_REPERTOIRE + 1) * TAILLE_REPERTOIRE;
+                        case_ = 0;
+                        continue;
+                    }
+                    const Bloc* bloc = blocDe(racine_, bloc_);
+                    if (bloc && bloc->occupees > 0) {
+                        for (; case_ < TailleBloc; ++case_) {
+                            if (bloc->cases[case_].valeur) return;
+                        }
+                    }
+                    ++bloc_;
+                    case_ = 0;
+                }
+                bloc_ = nombre_blocs_;
+                case_ = 0;
+            }
+        };
+
+        std::size_t size() const { return taille_; }
+        bool empty() const { return taille_ == 0; }
+
+        const_iterator begin() const { return const_iterator(racine_.get(), nombre_blocs_, 0, 0); }
+        const_iterator end() const { return const_iterator(racine_.get(), nombre_blocs_, nombre_blocs_, 0); }
+
+        // Premier élément dont l'id est supérieur ou égal à id
+        const_iterator lower_bound(int id) const {
+            if (id <= 0) return begin();
+            std::size_t position = static_cast<std::size_t>(id);
+            if (position / TailleBloc >= nombre_blocs_) return end();
+            return const_iterator(racine_.get(), nombre_blocs_, position / TailleBloc, position % TailleBloc);
+        }
+
+        const T* find(int id) const {
+            const Case* c = caseDe(id);
+            return c ? c->valeur.get() : nullptr;
+        }
+
+        const T* find(const Cle& cle) const {
+            const Case* c = caseDe(cle.id);
+            return (c && c->generation == cle.generation) ? c->valeur.get() : nullptr;
+        }
+
+        // Pointeur partagé vers la valeur, pour la conserver au-delà de la table
+        std::shared_ptr<const T> share(int id) const {
+            const Case* c = caseDe(id);
+            return c ? c->valeur : nullptr;
+        }
+
+        // Insérer ou remplacer la valeur associée à id ; std::out_of_range hors de [0, ID_MAX]
+        Cle assign(int id, T valeur) {
+            if (!idValide(id)) {
+                throw std::out_of_range("Identifiant hors de la table: " + std::to_string(id));
+            }
+            std::size_t position = static_cast<std::size_t>(id);
+            Bloc& bloc = blocModifiable(position / TailleBloc);
+            Case& c = bloc.cases[position % TailleBloc];
+            if (!c.valeur) {
+                ++bloc.occupees;
+                ++taille_;
+            }
+            c.valeur = std::make_shared<const T>(std::move(valeur));
+            return { id, c.generation };
+        }
+
+        bool erase(int id) {
+            const Case* existante = caseDe(id);
+            if (!existante || !existante->valeur) return false;
+
+            std::size_t position = static_cast<std::size_t>(id);
+            Bloc& bloc = blocModifiable(position / TailleBloc);
+            Case& c = bloc.cases[position % TailleBloc];
+            c.valeur.reset();
+            ++c.generation;
+            --bloc.occupees;
+            --taille_;
+            return true;
+        }
+
+        Cle cle(int id) const {
+            const Case* c = caseDe(id);
+            return { id, c ? c->generation : 0 };
+        }
+    };
+
+} // namespace crowjourney
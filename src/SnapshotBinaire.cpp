@@ -0,0 +1,189 @@
+#include "SnapshotBinaire.h"
+#include "Traces.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace crowjourney {
+
+    EcrivainSnapshot::EcrivainSnapshot(const char (&type)[5], std::uint32_t version_schema,
+        std::uint32_t champs_entiers, std::uint32_t champs_chaines) {
+        std::memcpy(entete_.magie, snapshot::MAGIE, sizeof(entete_.magie));
+        entete_.version_format = snapshot::VERSION_FORMAT;
+        std::memcpy(entete_.type, type, sizeof(entete_.type));
+        entete_.version_schema = version_schema;
+        entete_.champs_entiers = champs_entiers;
+        entete_.champs_chaines = champs_chaines;
+    }
+
+    void EcrivainSnapshot::ajouter(std::initializer_list<std::int64_t> entiers,
+        std::initializer_list<std::string_view> chaines) {
+        for (std::int64_t valeur : entiers) {
+            enregistrements_.append(reinterpret_cast<const char*>(&valeur), sizeof(valeur));
+        }
+        for (std::string_view valeur : chaines) {
+            auto [it, nouvelle] = offsets_.try_emplace(std::string(valeur), chaines_.size());
+            if (nouvelle) {
+                chaines_.append(valeur);
+            }
+            snapshot::RefChaine ref{ it->second, static_cast<std::uint32_t>(valeur.size()), 0 };
+            enregistrements_.append(reinterpret_cast<const char*>(&ref), sizeof(ref));
+        }
+        ++entete_.nombre_enregistrements;
+    }
+
+    std::string EcrivainSnapshot::terminer(std::uint64_t sequence, std::int64_t prochain_id) const {
+        snapshot::EnTete entete = entete_;
+        entete.sequence = sequence;
+        entete.prochain_id = prochain_id;
+        entete.offset_enregistrements = sizeof(snapshot::EnTete);
+        entete.offset_chaines = entete.offset_enregistrements + enregistrements_.size();
+        entete.taille_chaines = chaines_.size();
+
+        std::string contenu;
+        contenu.reserve(entete.offset_chaines + chaines_.size());
+        contenu.append(reinterpret_cast<const char*>(&entete), sizeof(entete));
+        contenu.append(enregistrements_);
+        contenu.append(chaines_);
+        return contenu;
+    }
+
+    SnapshotBinaire::~SnapshotBinaire() {
+        fermer();
+    }
+
+    bool SnapshotBinaire::ouvrir(const std::string& chemin, const char (&type)[5], std::uint32_t version_schema) {
+        std::uint32_t version_lue = 0;
+        return ouvrir(chemin, type, { version_schema }, version_lue);
+    }
+
+    bool SnapshotBinaire::ouvrir(const std::string& chemin, const char (&type)[5],
+        std::initializer_list<std::uint32_t> versions_schema, std::uint32_t& version_lue) {
+        fermer();
+
+#ifdef _WIN32
+        HANDLE fichier = CreateFileA(chemin.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fichier == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER taille;
+        if (!GetFileSizeEx(fichier, &taille) || taille.QuadPart == 0) {
+            CloseHandle(fichier);
+            return false;
+        }
+        HANDLE projection = CreateFileMappingA(fichier, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!projection) {
+            CloseHandle(fichier);
+            return false;
+        }
+        donnees_ = static_cast<const char*>(MapViewOfFile(projection, FILE_MAP_READ, 0, 0, 0));
+        if (!donnees_) {
+            CloseHandle(projection);
+            CloseHandle(fichier);
+            return false;
+        }
+        fichier_ = fichier;
+        projection_ = projection;
+        taille_ = static_cast<std::size_t>(taille.QuadPart);
+#else
+        int fd = ::open(chemin.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat infos;
+        if (fstat(fd, &infos) != 0 || infos.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* adresse = mmap(nullptr, static_cast<std::size_t>(infos.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // La projection reste valide après la fermeture du descripteur
+        if (adresse == MAP_FAILED) {
+            return false;
+        }
+        donnees_ = static_cast<const char*>(adresse);
+        taille_ = static_cast<std::size_t>(infos.st_size);
+#endif
+
+        // Validation de l'en-tête et des bornes des sections
+        const auto* entete = reinterpret_cast<const snapshot::EnTete*>(donnees_);
+        bool valide = taille_ >= sizeof(snapshot::EnTete)
+            && std::memcmp(entete->magie, snapshot::MAGIE, sizeof(entete->magie)) == 0
+            && entete->version_format == snapshot::VERSION_FORMAT
+            && std::memcmp(entete->type, type, sizeof(entete->type)) == 0
+            && std::find(versions_schema.begin(), versions_schema.end(), entete->version_schema) != versions_schema.end();
+        if (valide) {
+            taille_enregistrement_ = entete->champs_entiers * sizeof(std::int64_t)
+                + entete->champs_chaines * sizeof(snapshot::RefChaine);
+            valide = entete->offset_enregistrements >= sizeof(snapshot::EnTete)
+                && entete->offset_enregistrements <= taille_
+                && (taille_enregistrement_ == 0
+                    || entete->nombre_enregistrements <= (taille_ - entete->offset_enregistrements) / taille_enregistrement_)
+                && entete->offset_chaines >= entete->offset_enregistrements + entete->nombre_enregistrements * taille_enregistrement_
+                && entete->offset_chaines <= taille_
+                && entete->taille_chaines <= taille_ - entete->offset_chaines;
+        }
+        if (!valide) {
+            TRACE_AVERTISSEMENT("Instantané binaire invalide", traces::champ("chemin", chemin));
+            fermer();
+            return false;
+        }
+        entete_ = entete;
+        version_lue = entete->version_schema;
+        return true;
+    }
+
+    void SnapshotBinaire::fermer() {
+        if (donnees_) {
+#ifdef _WIN32
+            UnmapViewOfFile(donnees_);
+            CloseHandle(static_cast<HANDLE>(projection_));
+            CloseHandle(static_cast<HANDLE>(fichier_));
+            projection_ = nullptr;
+            fichier_ = nullptr;
+#else
+            munmap(const_cast<char*>(donnees_), taille_);
+#endif
+        }
+        donnees_ = nullptr;
+        taille_ = 0;
+        entete_ = nullptr;
+        taille_enregistrement_ = 0;
+    }
+
+    std::int64_t SnapshotBinaire::entier(std::size_t indice, std::uint32_t champ) const {
+        if (indice >= size() || champ >= entete_->champs_entiers) {
+            return 0;
+        }
+        std::int64_t valeur;
+        std::memcpy(&valeur, enregistrement(indice) + champ * sizeof(std::int64_t), sizeof(valeur));
+        return valeur;
+    }
+
+    std::string_view SnapshotBinaire::chaine(std::size_t indice, std::uint32_t champ) const {
+        if (indice >= size() || champ >= entete_->champs_chaines) {
+            return {};
+        }
+        snapshot::RefChaine ref;
+        std::memcpy(&ref, enregistrement(indice) + entete_->champs_entiers * sizeof(std::int64_t)
+            + champ * sizeof(snapshot::RefChaine), sizeof(ref));
+
+        // Une référence hors de la table (fichier altéré) donne une chaîne vide
+        if (ref.offset > entete_->taille_chaines || ref.longueur > entete_->taille_chaines - ref.offset) {
+            return {};
+        }
+        return std::string_view(donnees_ + entete_->offset_chaines + ref.offset, ref.longueur);
+    }
+
+} // namespace crowjourney
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crowjourney {
+
+    // Format binaire des instantanés, conçu pour être projeté en mémoire (mmap) :
+    //
+    //   [EnTete][enregistrements de taille fixe][table des chaînes]
+    //
+    // Chaque enregistrement contient `champs_entiers` entiers 64 bits suivis de
+    // `champs_chaines` références (offset, longueur) vers la table des chaînes, où
+    // les valeurs identiques ne sont stockées qu'une fois. L'accès à l'enregistrement i
+    // est direct et la lecture n'analyse rien tant qu'un champ n'est pas demandé.
+    namespace snapshot {
+
+        constexpr char MAGIE[8] = { 'C', 'J', 'S', 'N', 'A', 'P', '\0', '\0' };
+        constexpr std::uint32_t VERSION_FORMAT = 1;
+
+        struct EnTete {
+            char magie[8];
+            std::uint32_t version_format;
+            char type[4];                  // "LIVR", "USER"...
+            std::uint32_t version_schema;  // Version des champs propre au type
+            std::uint32_t champs_entiers;
+            std::uint32_t champs_chaines;
+            std::uint32_t reserve;
+            std::uint64_t sequence;        // Dernière séquence du journal couverte
+            std::int64_t prochain_id;
+            std::uint64_t nombre_enregistrements;
+            std::uint64_t offset_enregistrements;
+            std::uint64_t offset_chaines;
+            std::uint64_t taille_chaines;
+        };
+
+        struct RefChaine {
+            std::uint64_t offset;
+            std::uint32_t longueur;
+            std::uint32_t reserve;
+        };
+
+        static_assert(sizeof(EnTete) % 8 == 0, "En-tête aligné sur 8 octets");
+        static_assert(sizeof(RefChaine) == 16, "Référence de chaîne sur 16 octets");
+    }
+
+    // Construction d'un instantané binaire en mémoire
+    class EcrivainSnapshot {
+    public:
+        EcrivainSnapshot(const char (&type)[5], std::uint32_t version_schema,
+            std::uint32_t champs_entiers, std::uint32_t champs_chaines);
+
+        void ajouter(std::initializer_list<std::int64_t> entiers, std::initializer_list<std::string_view> chaines);
+
+        // Produire le contenu du fichier
+        std::string terminer(std::uint64_t sequence, std::int64_t prochain_id) const;
+
+    private:
+        snapshot::EnTete entete_{};
+        std::string enregistrements_;
+        std::string chaines_;
+        std::unordered_map<std::string, std::uint64_t> offsets_; // Déduplication de la table
+    };
+
+    // Lecture d'un instantané binaire projeté en mémoire
+    class SnapshotBinaire {
+    public:
+        SnapshotBinaire() = default;
+        ~SnapshotBinaire();
+
+        SnapshotBinaire(const SnapshotBinaire&) = delete;
+        SnapshotBinaire& operator=(const SnapshotBinaire&) = delete;
+
+        // Projeter et valider le fichier ; false s'il est absent, d'un autre type ou corrompu
+        bool ouvrir(const std::string& chemin, const char (&type)[5], std::uint32_t version_schema);
+
+        // Même chose pour un type lisible dans plusieurs schémas : accepte toute version de
+        // versions_schema et renvoie dans version_lue celle de l'en-tête
+        bool ouvrir(const std::string& chemin, const char (&type)[5],
+            std::initializer_list<std::uint32_t> versions_schema, std::uint32_t& version_lue);
+        void fermer();
+
+        std::size_t size() const { return entete_ ? static_cast<std::size_t>(entete_->nombre_enregistrements) : 0; }
+        std::uint64_t sequence() const { return entete_ ? entete_->sequence : 0; }
+        std::int64_t prochainId() const { return entete_ ? entete_->prochain_id : 0; }
+
+        std::int64_t entier(std::size_t enregistrement, std::uint32_t champ) const;
+
+        // Vue sur la chaîne dans la projection : valide tant que le fichier reste ouvert
+        std::string_view chaine(std::size_t enregistrement, std::uint32_t champ) const;
+
+    private:
+        const char* donnees_ = nullptr;
+        std::size_t taille_ = 0;
+        const snapshot::EnTete* entete_ = nullptr;
+        std::size_t taille_enregistrement_ = 0;
+#ifdef _WIN32
+        void* fichier_ = nullptr;
+        void* projection_ = nullptr;
+#endif
+
+        const char* enregistrement(std::size_t indice) const {
+            return donnees_ + entete_->offset_enregistrements + indice * taille_enregistrement_;
+        }
+    };
+
+} // namespace crowjourney
@@ -0,0 +1,129 @@
+#include "StatistiquesLivres.h"
+#include "library.h"
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace crowjourney {
+
+    namespace {
+        std::int64_t decennie(int annee) {
+            std::int64_t a = annee;
+            return (a >= 0 ? a / 10 : -((-a + 9) / 10)) * 10;
+        }
+
+        template <typename Compteurs, typename Cle>
+        void decrementer(Compteurs& compteurs, const Cle& cle) {
+            auto it = compteurs.find(cle);
+            if (it != compteurs.end() && --it->second == 0) {
+                compteurs.erase(it);
+            }
+        }
+
+        // Ordre d'affichage : nombre de livres décroissant, puis nom croissant
+        template <typename Cle>
+        bool avant(const std::pair<Cle, std::size_t>& a, const std::pair<Cle, std::size_t>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        }
+    }
+
+    void StatistiquesLivres::ajouter(const Livre& livre) {
+        ++total_;
+        ++par_genre_[livre.genre];
+        ++par_auteur_[livre.auteur];
+        ++par_decennie_[decennie(livre.annee)];
+    }
+
+    void StatistiquesLivres::retirer(const Livre& livre) {
+        if (total_ == 0) {
+            return;
+        }
+        --total_;
+        decrementer(par_genre_, livre.genre);
+        decrementer(par_auteur_, livre.auteur);
+        decrementer(par_decennie_, decennie(livre.annee));
+    }
+
+    void StatistiquesLivres::remplacer(const Livre* avant, const Livre* apres) {
+        if (avant) {
+            retirer(*avant);
+        }
+        if (apres) {
+            ajouter(*apres);
+        }
+    }
+
+    void StatistiquesLivres::vider() {
+        total_ = 0;
+        par_genre_.clear();
+        par_auteur_.clear();
+        par_decennie_.clear();
+    }
+
+    void StatistiquesLivres::ecrire(JsonWriter& sortie, std::size_t top) const {
+        using Entree = std::pair<std::string_view, std::size_t>;
+
+        // Les k meilleurs auteurs en O(A log k) : le sommet du tas est le moins bon retenu
+        std::vector<Entree> auteurs;
+        if (top > 0) {
+            auto comparer = [](const Entree& a, const Entree& b) { return avant(a, b); };
+            std::priority_queue<Entree, std::vector<Entree>, decltype(comparer)> tas(comparer);
+            for (const auto& [auteur, livres] : par_auteur_) {
+                Entree entree(auteur, livres);
+                if (tas.size() < top) {
+                    tas.push(entree);
+                }
+                else if (avant(entree, tas.top())) {
+                    tas.pop();
+                    tas.push(entree);
+                }
+            }
+            auteurs.reserve(tas.size());
+            for (; !tas.empty(); tas.pop()) {
+                auteurs.push_back(tas.top());
+            }
+            std::reverse(auteurs.begin(), auteurs.end());
+        }
+
+        std::vector<Entree> genres(par_genre_.begin(), par_genre_.end());
+        std::sort(genres.begin(), genres.end(), avant<std::string_view>);
+
+        std::vector<std::pair<std::int64_t, std::size_t>> decennies(par_decennie_.begin(), par_decennie_.end());
+        std::sort(decennies.begin(), decennies.end());
+
+        sortie.debutObjet()
+            .champ("total", static_cast<std::uint64_t>(total_))
+            .champ("auteurs", static_cast<std::uint64_t>(par_auteur_.size()));
+
+        sortie.cle("par_genre").debutTableau();
+        for (const auto& [genre, livres] : genres) {
+            sortie.debutObjet()
+                .champ("genre", genre)
+                .champ("livres", static_cast<std::uint64_t>(livres))
+                .finObjet();
+        }
+        sortie.finTableau();
+
+        sortie.cle("par_decennie").debutTableau();
+        for (const auto& [debut, livres] : decennies) {
+            sortie.debutObjet()
+                .champ("decennie", debut)
+                .champ("livres", static_cast<std::uint64_t>(livres))
+                .finObjet();
+        }
+        sortie.finTableau();
+
+        sortie.cle("top_auteurs").debutTableau();
+        for (const auto& [auteur, livres] : auteurs) {
+            sortie.debutObjet()
+                .champ("auteur", auteur)
+                .champ("livres", static_cast<std::uint64_t>(livres))
+                .finObjet();
+        }
+        sortie.finTableau();
+
+        sortie.finObjet();
+    }
+
+} // namespace crowjourney
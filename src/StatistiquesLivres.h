@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "ChaineInternee.h"
+
+struct Livre;
+
+namespace crowjourney {
+
+    class JsonWriter;
+
+    // Compteurs de GET /books/stats : total, livres par genre, par auteur et par décennie.
+    // Chaque mutation les ajuste en temps constant (remplacer) ; rien n'est recalculé
+    // à partir du catalogue, sauf au chargement.
+    //
+    // Comme IndexLivres, la structure n'est pas synchronisée : le gestionnaire la
+    // modifie et la lit sous son verrou d'index.
+    class StatistiquesLivres {
+    public:
+        void ajouter(const Livre& livre);
+        void retirer(const Livre& livre);
+
+        // Remplacer l'état compté d'un livre (avant ou apres peut être nul)
+        void remplacer(const Livre* avant, const Livre* apres);
+
+        void vider();
+
+        // Écrire l'objet JSON des statistiques ; top : nombre d'auteurs de top_auteurs,
+        // choisis par un tas borné à top éléments
+        void ecrire(JsonWriter& sortie, std::size_t top) const;
+
+    private:
+        std::size_t total_ = 0;
+        std::unordered_map<ChaineInternee, std::size_t> par_genre_;
+        std::unordered_map<ChaineInternee, std::size_t> par_auteur_;
+        std::unordered_map<std::int64_t, std::size_t> par_decennie_; // Clé : première année de la décennie
+    };
+
+} // namespace crowjourney
@@ -0,0 +1,449 @@
+#include "Suggestions.h"
+#include "RechercheTexte.h"
+#include "library.h"
+#include <algorithm>
+#include <queue>
+
+namespace crowjourney {
+
+    namespace {
+        // Au-delà, la saisie est tronquée et l'exploration interrompue
+        constexpr std::size_t LONGUEUR_SAISIE_MAX = 64;
+        constexpr std::size_t VISITES_MAX = 20000;
+
+        std::uint32_t distanceAdmise(std::size_t longueur) {
+            return longueur <= 3 ? 0 : (longueur <= 7 ? 1 : 2);
+        }
+
+        // Clé de par_cle_ : type ('a' ou 't') + texte
+        std::string cle(std::string_view texte, bool auteur) {
+            std::string resultat(1, auteur ? 'a' : 't');
+            resultat.append(texte);
+            return resultat;
+        }
+    }
+
+    void Suggestions::ajouter(const Livre& livre) {
+        ajouterTexte(livre.titre, false);
+        ajouterTexte(livre.auteur, true);
+    }
+
+    void Suggestions::retirer(const Livre& livre) {
+        retirerTexte(livre.titre, false);
+        retirerTexte(livre.auteur, true);
+    }
+
+    void Suggestions::remplacer(const Livre* avant, const Livre* apres) {
+        if (!avant || !apres) {
+            if (avant) retirer(*avant);
+            if (apres) ajouter(*apres);
+            return;
+        }
+        if (avant->titre != apres->titre) {
+            retirerTexte(avant->titre, false);
+            ajouterTexte(apres->titre, false);
+        }
+        if (avant->auteur != apres->auteur) {
+            retirerTexte(avant->auteur, true);
+            ajouterTexte(apres->auteur, true);
+        }
+    }
+
+    void Suggestions::vider() {
+        noeuds_.assign(1, Noeud{});
+        noeuds_libres_.clear();
+        textes_par_noeud_.clear();
+        textes_.clear();
+        textes_libres_.clear();
+        par_cle_.clear();
+        chargement_ = false;
+    }
+
+    void Suggestions::commencerChargement() {
+        vider();
+        chargement_ = true;
+    }
+
+    void Suggestions::terminerChargement() {
+        chargement_ = false;
+        for (auto& [noeud, ids] : textes_par_noeud_) {
+            std::sort(ids.begin(), ids.end(), [this](std::uint32_t a, std::uint32_t b) {
+                return textes_[a].livres > textes_[b].livres || (textes_[a].livres == textes_[b].livres && a < b);
+            });
+            noeuds_[noeud].meilleur = textes_[ids.front()].livres;
+        }
+        // Sans libération pendant le chargement, un enfant a toujours un indice supérieur à son parent
+        for (std::size_t n = noeuds_.size(); n-- > 1;) {
+            Noeud& parent = noeuds_[noeuds_[n].parent];
+            parent.meilleur = std::max(parent.meilleur, noeuds_[n].meilleur);
+        }
+    }
+
+    std::uint32_t Suggestions::enfant(std::uint32_t noeud, char octet) const {
+        for (std::uint32_t c = noeuds_[noeud].premier_enfant; c != AUCUN; c = noeuds_[c].frere) {
+            if (noeuds_[c].octet == octet) return c;
+            if (static_cast<unsigned char>(noeuds_[c].octet) > static_cast<unsigned char>(octet)) break;
+        }
+        return AUCUN;
+    }
+
+    std::uint32_t Suggestions::inserer(std::string_view mot) {
+        std::uint32_t noeud = 0;
+        for (char octet : mot) {
+            std::uint32_t suivant = enfant(noeud, octet);
+            if (suivant == AUCUN) {
+                if (!noeuds_libres_.empty()) {
+                    suivant = noeuds_libres_.back();
+                    noeuds_libres_.pop_back();
+                }
+                else {
+                    suivant = static_cast<std::uint32_t>(noeuds_.size());
+                    noeuds_.emplace_back();
+                }
+                Noeud& nouveau = noeuds_[suivant];
+                nouveau = Noeud{};
+                nouveau.parent = noeud;
+                nouveau.octet = octet;
+                nouveau.profondeur = static_cast<std::uint16_t>(noeuds_[noeud].profondeur + 1);
+
+                // Insertion dans la liste des frères, triée par octet
+                std::uint32_t* lien = &noeuds_[noeud].premier_enfant;
+                while (*lien != AUCUN && static_cast<unsigned char>(noeuds_[*lien].octet) < static_cast<unsigned char>(octet)) {
+                    lien = &noeuds_[*lien].frere;
+                }
+                nouveau.frere = *lien;
+                *lien = suivant;
+            }
+            noeud = suivant;
+        }
+        return noeud;
+    }
+
+    void Suggestions::detacher(std::uint32_t noeud) {
+        std::uint32_t* lien = &noeuds_[noeuds_[noeud].parent].premier_enfant;
+        while (*lien != noeud) {
+            lien = &noeuds_[*lien].frere;
+        }
+        *lien = noeuds_[noeud].frere;
+        noeuds_[noeud].parent = AUCUN;
+        noeuds_libres_.push_back(noeud);
+    }
+
+    void Suggestions::recalculer(std::uint32_t noeud) {
+        while (noeud != AUCUN) {
+            Noeud& courant = noeuds_[noeud];
+            if (noeud != 0 && courant.parent == AUCUN) {
+                return; // Déjà libéré en remontant depuis un autre mot du même texte
+            }
+            const std::uint32_t parent = courant.parent;
+            if (noeud != 0 && !courant.terminal && courant.premier_enfant == AUCUN) {
+                detacher(noeud);
+                noeud = parent;
+                continue;
+            }
+
+            std::uint32_t meilleur = 0;
+            if (courant.terminal) {
+                meilleur = textes_[textes_par_noeud_[noeud].front()].livres; // Liste triée
+            }
+            for (std::uint32_t c = courant.premier_enfant; c != AUCUN; c = noeuds_[c].frere) {
+                meilleur = std::max(meilleur, noeuds_[c].meilleur);
+            }
+            if (meilleur == courant.meilleur) {
+                return; // Les ancêtres ne changent pas
+            }
+            courant.meilleur = meilleur;
+            noeud = parent;
+        }
+    }
+
+    void Suggestions::placer(std::uint32_t noeud, std::uint32_t id, std::uint32_t ancien) {
+        // Ordre des listes : nombre de livres décroissant, puis id croissant
+        auto precede = [](std::uint32_t livres_a, std::uint32_t a, std::uint32_t livres_b, std::uint32_t b) {
+            return livres_a > livres_b || (livres_a == livres_b && a < b);
+        };
+        auto& ids = textes_par_noeud_[noeud];
+        if (ancien > 0) {
+            auto position = std::lower_bound(ids.begin(), ids.end(), id, [&](std::uint32_t x, std::uint32_t) {
+                return precede(x == id ? ancien : textes_[x].livres, x, ancien, id);
+            });
+            ids.erase(position);
+        }
+        const std::uint32_t livres = textes_[id].livres;
+        if (livres > 0) {
+            auto position = std::lower_bound(ids.begin(), ids.end(), id, [&](std::uint32_t x, std::uint32_t) {
+                return precede(textes_[x].livres, x, livres, id);
+            });
+            ids.insert(position, id);
+        }
+    }
+
+    void Suggestions::ajouterTexte(std::string_view texte, bool auteur) {
+        if (texte.empty()) {
+            return;
+        }
+        auto [it, nouveau] = par_cle_.try_emplace(cle(texte, auteur), 0);
+        if (nouveau) {
+            std::uint32_t id;
+            if (!textes_libres_.empty()) {
+                id = textes_libres_.back();
+                textes_libres_.pop_back();
+            }
+            else {
+                id = static_cast<std::uint32_t>(textes_.size());
+                textes_.emplace_back();
+            }
+            it->second = id;
+
+            Texte& entree = textes_[id];
+            entree = Texte{};
+            entree.texte = std::string(texte);
+            entree.auteur = auteur;
+
+            std::vector<std::string> mots = extraireMots(texte);
+            std::sort(mots.begin(), mots.end());
+            mots.erase(std::unique(mots.begin(), mots.end()), mots.end());
+            for (const auto& mot : mots) {
+                std::uint32_t noeud = inserer(mot);
+                noeuds_[noeud].terminal = true;
+                textes_[id].noeuds.push_back(noeud);
+            }
+        }
+
+        const std::uint32_t id = it->second;
+        Texte& entree = textes_[id];
+        ++entree.livres;
+        if (chargement_) {
+            // Listes triées et maxima calculés une seule fois par terminerChargement()
+            if (nouveau) {
+                for (std::uint32_t noeud : entree.noeuds) {
+                    textes_par_noeud_[noeud].push_back(id);
+                }
+            }
+            return;
+        }
+        for (std::uint32_t noeud : entree.noeuds) {
+            placer(noeud, id, entree.livres - 1);
+            for (std::uint32_t n = noeud; n != AUCUN && noeuds_[n].meilleur < entree.livres; n = noeuds_[n].parent) {
+                noeuds_[n].meilleur = entree.livres;
+            }
+        }
+    }
+
+    void Suggestions::retirerTexte(std::string_view texte, bool auteur) {
+        auto it = par_cle_.find(cle(texte, auteur));
+        if (it == par_cle_.end()) {
+            return;
+        }
+        const std::uint32_t id = it->second;
+        std::vector<std::uint32_t> noeuds = textes_[id].noeuds;
+
+        --textes_[id].livres;
+        for (std::uint32_t noeud : noeuds) {
+            placer(noeud, id, textes_[id].livres + 1);
+            auto liste = textes_par_noeud_.find(noeud);
+            if (liste->second.empty()) {
+                textes_par_noeud_.erase(liste);
+                noeuds_[noeud].terminal = false;
+            }
+        }
+        if (textes_[id].livres == 0) {
+            textes_[id] = Texte{};
+            textes_libres_.push_back(id);
+            par_cle_.erase(it);
+        }
+
+        for (std::uint32_t noeud : noeuds) {
+            recalculer(noeud);
+        }
+    }
+
+    std::vector<Suggestions::Resultat> Suggestions::suggerer(std::string_view saisie, std::size_t limite) const {
+        std::vector<std::string> mots = extraireMots(saisie.substr(0, LONGUEUR_SAISIE_MAX), 1);
+        if (mots.empty() || limite == 0) {
+            return {};
+        }
+        const std::string prefixe = std::move(mots.back());
+        mots.pop_back();
+
+        // Les mots complets qui précèdent doivent figurer dans le texte suggéré
+        std::vector<std::uint32_t> requis;
+        for (const auto& mot : mots) {
+            if (mot.size() < 2) {
+                continue; // Non indexés
+            }
+            std::uint32_t noeud = 0;
+            for (char octet : mot) {
+                noeud = enfant(noeud, octet);
+                if (noeud == AUCUN) return {};
+            }
+            if (!noeuds_[noeud].terminal) return {};
+            requis.push_back(noeud);
+        }
+
+        // Nœuds dont le chemin est à distance d'édition bornée du préfixe saisi
+        // (distance de Levenshtein calculée ligne par ligne en descendant le trie)
+        struct Depart {
+            std::uint32_t noeud;
+            std::uint32_t distance;
+        };
+        std::vector<Depart> departs;
+        const std::uint32_t admise = distanceAdmise(prefixe.size());
+        const std::size_t m = prefixe.size();
+
+        std::vector<std::uint32_t> racine(m + 1);
+        for (std::size_t j = 0; j <= m; ++j) racine[j] = static_cast<std::uint32_t>(j);
+
+        // Pile d'exploration : nœud, ligne de la matrice, meilleure distance d'un ancêtre retenu
+        struct Etape {
+            std::uint32_t noeud;
+            std::vector<std::uint32_t> ligne;
+            std::uint32_t distance_ancetre;
+        };
+        std::vector<Etape> pile;
+        pile.push_back({ 0, std::move(racine), admise + 1 });
+        std::size_t visites = 0;
+        while (!pile.empty() && visites < VISITES_MAX) {
+            Etape etape = std::move(pile.back());
+            pile.pop_back();
+            ++visites;
+
+            std::uint32_t distance_ancetre = etape.distance_ancetre;
+            if (etape.ligne[m] < distance_ancetre) {
+                departs.push_back({ etape.noeud, etape.ligne[m] });
+                distance_ancetre = etape.ligne[m];
+            }
+            if (distance_ancetre == 0) {
+                continue; // Tout le sous-arbre est déjà couvert sans correction
+            }
+
+            for (std::uint32_t c = noeuds_[etape.noeud].premier_enfant; c != AUCUN; c = noeuds_[c].frere) {
+                std::vector<std::uint32_t> ligne(m + 1);
+                ligne[0] = etape.ligne[0] + 1;
+                std::uint32_t minimum = ligne[0];
+                for (std::size_t j = 1; j <= m; ++j) {
+                    const std::uint32_t substitution = etape.ligne[j - 1] + (prefixe[j - 1] != noeuds_[c].octet ? 1 : 0);
+                    ligne[j] = std::min({ etape.ligne[j] + 1, ligne[j - 1] + 1, substitution });
+                    minimum = std::min(minimum, ligne[j]);
+                }
+                if (minimum <= admise) {
+                    pile.push_back({ c, std::move(ligne), distance_ancetre });
+                }
+            }
+        }
+
+        std::vector<Resultat> resultats;
+        if (departs.empty()) {
+            return resultats;
+        }
+
+        if (!requis.empty()) {
+            // Les textes candidats sont ceux du mot requis le plus rare, par nombre de livres
+            // décroissant ; un mot de chacun doit descendre d'un nœud retenu
+            std::unordered_map<std::uint32_t, std::uint32_t> distances;
+            for (const auto& depart : departs) {
+                distances.emplace(depart.noeud, depart.distance);
+            }
+            const std::vector<std::uint32_t>* candidats = nullptr;
+            for (std::uint32_t noeud : requis) {
+                const auto& liste = textes_par_noeud_.at(noeud);
+                if (!candidats || liste.size() < candidats->size()) {
+                    candidats = &liste;
+                }
+            }
+
+            struct Candidat {
+                std::uint32_t distance;
+                std::uint32_t id;
+            };
+            std::vector<Candidat> retenus;
+            for (std::uint32_t id : *candidats) {
+                if (++visites > VISITES_MAX) break;
+                const Texte& texte = textes_[id];
+                bool complet = std::all_of(requis.begin(), requis.end(), [&texte](std::uint32_t noeud) {
+                    return std::find(texte.noeuds.begin(), texte.noeuds.end(), noeud) != texte.noeuds.end();
+                });
+                if (!complet) {
+                    continue;
+                }
+                std::uint32_t distance = AUCUN;
+                for (std::uint32_t noeud : texte.noeuds) {
+                    for (std::uint32_t n = noeud; n != AUCUN; n = noeuds_[n].parent) {
+                        auto trouve = distances.find(n);
+                        if (trouve != distances.end()) {
+                            distance = std::min(distance, trouve->second);
+                        }
+                    }
+                }
+                if (distance != AUCUN) {
+                    retenus.push_back({ distance, id });
+                    if (distance == 0 && retenus.size() >= limite
+                        && std::count_if(retenus.begin(), retenus.end(), [](const Candidat& c) { return c.distance == 0; }) >= static_cast<std::ptrdiff_t>(limite)) {
+                        break; // Les suivants ont au plus autant de livres et ne passeraient pas devant
+                    }
+                }
+            }
+            std::stable_sort(retenus.begin(), retenus.end(), [](const Candidat& a, const Candidat& b) { return a.distance < b.distance; });
+            for (std::size_t i = 0; i < retenus.size() && i < limite; ++i) {
+                const Texte& texte = textes_[retenus[i].id];
+                resultats.push_back({ texte.texte, texte.auteur, texte.livres, retenus[i].distance });
+            }
+            return resultats;
+        }
+
+        // Parcours du meilleur d'abord depuis les nœuds retenus : un nœud passe avant ses
+        // textes tant que son sous-arbre peut en contenir un meilleur. Les textes d'un nœud,
+        // triés par nombre de livres, sont pris un à un (indice dans la liste).
+        struct Element {
+            std::uint32_t distance;
+            std::uint32_t livres;
+            std::uint32_t profondeur;
+            std::uint32_t noeud;
+            std::uint32_t indice; // AUCUN : le nœud lui-même
+        };
+        auto apres = [](const Element& a, const Element& b) {
+            if (a.distance != b.distance) return a.distance > b.distance;
+            if (a.livres != b.livres) return a.livres < b.livres;
+            if ((a.indice == AUCUN) != (b.indice == AUCUN)) return a.indice == AUCUN;
+            return a.profondeur > b.profondeur;
+        };
+        std::priority_queue<Element, std::vector<Element>, decltype(apres)> file(apres);
+        for (const auto& depart : departs) {
+            const Noeud& noeud = noeuds_[depart.noeud];
+            file.push({ depart.distance, noeud.meilleur, noeud.profondeur, depart.noeud, AUCUN });
+        }
+
+        std::vector<std::uint32_t> vus;
+        while (!file.empty() && resultats.size() < limite && visites < VISITES_MAX) {
+            Element element = file.top();
+            file.pop();
+            ++visites;
+            const Noeud& noeud = noeuds_[element.noeud];
+
+            if (element.indice != AUCUN) {
+                const auto& ids = textes_par_noeud_.at(element.noeud);
+                const std::uint32_t id = ids[element.indice];
+                if (std::find(vus.begin(), vus.end(), id) == vus.end()) {
+                    vus.push_back(id);
+                    const Texte& texte = textes_[id];
+                    resultats.push_back({ texte.texte, texte.auteur, texte.livres, element.distance });
+                }
+                if (element.indice + 1 < ids.size()) {
+                    file.push({ element.distance, textes_[ids[element.indice + 1]].livres, noeud.profondeur,
+                        element.noeud, element.indice + 1 });
+                }
+                continue;
+            }
+
+            if (noeud.terminal) {
+                const auto& ids = textes_par_noeud_.at(element.noeud);
+                file.push({ element.distance, textes_[ids.front()].livres, noeud.profondeur, element.noeud, 0 });
+            }
+            for (std::uint32_t c = noeud.premier_enfant; c != AUCUN; c = noeuds_[c].frere) {
+                file.push({ element.distance, noeuds_[c].meilleur, noeuds_[c].profondeur, c, AUCUN });
+            }
+        }
+        return resultats;
+    }
+
+} // namespace crowjourney
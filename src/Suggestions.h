@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Livre;
+
+namespace crowjourney {
+
+    // Autocomplétion des titres et des auteurs (GET /books/suggest).
+    //
+    // Chaque titre ou auteur distinct est un « texte » suggérable, compté par le nombre
+    // de livres qui le portent. Ses mots normalisés (voir extraireMots) sont rangés dans
+    // un trie d'octets compact : les nœuds, stockés dans un tableau, sont chaînés en
+    // premier enfant / frère suivant et retiennent le plus grand nombre de livres de leur
+    // sous-arbre, ce qui permet de trouver les k meilleures complétions en visitant
+    // peu de nœuds. La saisie est comparée au trie à distance d'édition bornée
+    // (0 jusqu'à 3 caractères, 1 jusqu'à 7, 2 au-delà).
+    //
+    // Comme IndexLivres, la structure n'est pas synchronisée : le gestionnaire la
+    // modifie et la lit sous son verrou d'index.
+    class Suggestions {
+    public:
+        struct Resultat {
+            std::string texte;
+            bool auteur;            // Auteur, sinon titre
+            std::uint32_t livres;   // Nombre de livres portant ce texte
+            std::uint32_t distance; // Corrections nécessaires pour correspondre à la saisie
+        };
+
+        void ajouter(const Livre& livre);
+        void retirer(const Livre& livre);
+
+        // Remplacer l'état indexé d'un livre (avant ou apres peut être nul)
+        void remplacer(const Livre* avant, const Livre* apres);
+
+        void vider();
+
+        // Chargement en bloc : entre ces deux appels, ajouter() ne fait qu'accumuler,
+        // le tri des listes et les maxima des sous-arbres sont calculés à la fin
+        void commencerChargement();
+        void terminerChargement();
+
+        // Les limite meilleures suggestions pour la saisie : le dernier mot est un préfixe,
+        // les mots précédents doivent figurer dans le texte. Classement par distance
+        // croissante, puis nombre de livres décroissant, puis complétion la plus courte.
+        std::vector<Resultat> suggerer(std::string_view saisie, std::size_t limite) const;
+
+    private:
+        static constexpr std::uint32_t AUCUN = std::numeric_limits<std::uint32_t>::max();
+
+        struct Noeud {
+            std::uint32_t parent = AUCUN;         // AUCUN pour la racine et les nœuds libérés
+            std::uint32_t premier_enfant = AUCUN;
+            std::uint32_t frere = AUCUN;          // Frère suivant, par octet croissant
+            std::uint32_t meilleur = 0;           // Plus grand nombre de livres d'un texte du sous-arbre
+            std::uint16_t profondeur = 0;
+            char octet = 0;
+            bool terminal = false;                // Des textes ont un mot qui se termine ici
+        };
+
+        struct Texte {
+            std::string texte;
+            bool auteur = false;
+            std::uint32_t livres = 0;
+            std::vector<std::uint32_t> noeuds; // Nœud terminal de chacun de ses mots
+        };
+
+        std::vector<Noeud> noeuds_{ Noeud{} }; // Indice 0 : racine
+        std::vector<std::uint32_t> noeuds_libres_;
+        std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> textes_par_noeud_; // Par nombre de livres décroissant, puis id
+
+        std::vector<Texte> textes_;
+        std::vector<std::uint32_t> textes_libres_;
+        std::unordered_map<std::string, std::uint32_t> par_cle_; // Type ('a' ou 't') + texte
+        bool chargement_ = false;
+
+        void ajouterTexte(std::string_view texte, bool auteur);
+        void retirerTexte(std::string_view texte, bool auteur);
+
+        std::uint32_t enfant(std::uint32_t noeud, char octet) const;
+        std::uint32_t inserer(std::string_view mot);
+        void detacher(std::uint32_t noeud);
+        void recalculer(std::uint32_t noeud); // Remonte vers la racine et élague les nœuds vides
+        // Replacer un texte dans la liste d'un nœud après un changement de son nombre de livres
+        // (ancien : nombre précédent, 0 s'il n'y figurait pas)
+        void placer(std::uint32_t noeud, std::uint32_t texte, std::uint32_t ancien);
+    };
+
+} // namespace crowjourney
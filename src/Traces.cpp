@@ -0,0 +1,259 @@
+#include "Traces.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crowjourney::traces {
+
+    namespace {
+        using detail::Emplacement;
+
+        constexpr std::size_t CAPACITE_TAMPON = 512; // Emplacements par thread
+
+        NiveauTrace niveauDepuisEnvironnement() {
+            const char* texte = std::getenv("CROWJOURNEY_LOG_LEVEL");
+            std::string_view nom = texte ? texte : "";
+            if (nom == "debug") return NiveauTrace::Debug;
+            if (nom == "avertissement" || nom == "warn") return NiveauTrace::Avertissement;
+            if (nom == "erreur" || nom == "error") return NiveauTrace::Erreur;
+            if (nom == "aucun" || nom == "off") return NiveauTrace::Aucun;
+            return NiveauTrace::Info;
+        }
+
+        const char* nomNiveau(NiveauTrace niveau) {
+            switch (niveau) {
+            case NiveauTrace::Debug: return "DEBUG";
+            case NiveauTrace::Info: return "INFO";
+            case NiveauTrace::Avertissement: return "AVERTISSEMENT";
+            default: return "ERREUR";
+            }
+        }
+
+        // Tampon circulaire d'un thread : seul ce thread avance `ecrites`,
+        // seul le thread de vidage avance `lues`
+        struct TamponThread {
+            std::array<Emplacement, CAPACITE_TAMPON> emplacements;
+            alignas(64) std::atomic<std::uint64_t> ecrites{ 0 };
+            alignas(64) std::atomic<std::uint64_t> lues{ 0 };
+            std::atomic<std::uint64_t> perdues{ 0 };
+            std::atomic<bool> termine{ false }; // Thread propriétaire terminé : retiré une fois vidé
+            std::uint32_t numero = 0;
+        };
+
+        std::atomic<bool> collecteur_arrete{ false };
+
+        std::int64_t horodatage() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // "2026-10-18T07:25:35.123Z NIVEAU [t3] texte\n"
+        void formater(std::string& sortie, std::int64_t instant_us, std::uint32_t thread,
+            NiveauTrace niveau, std::string_view texte) {
+            std::time_t secondes = static_cast<std::time_t>(instant_us / 1000000);
+            std::tm utc{};
+#ifdef _WIN32
+            gmtime_s(&utc, &secondes);
+#else
+            gmtime_r(&secondes, &utc);
+#endif
+            char tampon[64];
+            std::size_t n = std::strftime(tampon, sizeof(tampon), "%Y-%m-%dT%H:%M:%S", &utc);
+            n += std::snprintf(tampon + n, sizeof(tampon) - n, ".%03dZ %s [t%u] ",
+                static_cast<int>(instant_us / 1000 % 1000), nomNiveau(niveau), thread);
+            sortie.append(tampon, n);
+            sortie.append(texte);
+            sortie.push_back('\n');
+        }
+
+        // Thread de vidage et registre des tampons de thread
+        class Collecteur {
+        public:
+            Collecteur() : thread_(&Collecteur::boucle, this) {}
+
+            ~Collecteur() {
+                collecteur_arrete = true; // Les traces suivantes sont écrites directement
+                {
+                    std::lock_guard<std::mutex> verrou(mutex_);
+                    arret_ = true;
+                }
+                reveil_.notify_one();
+                thread_.join();
+            }
+
+            std::shared_ptr<TamponThread> inscrire() {
+                auto tampon = std::make_shared<TamponThread>();
+                std::lock_guard<std::mutex> verrou(mutex_);
+                tampon->numero = ++inscrits_;
+                tampons_.push_back(tampon);
+                return tampon;
+            }
+
+            // Écrire en un lot les traces de tous les tampons, dans l'ordre chronologique
+            void vider() {
+                std::lock_guard<std::mutex> vidage(vidage_mutex_);
+                {
+                    std::lock_guard<std::mutex> verrou(mutex_);
+                    actifs_ = tampons_;
+                    tampons_.erase(std::remove_if(tampons_.begin(), tampons_.end(), [](const auto& tampon) {
+                        return tampon->termine.load() && tampon->lues.load() == tampon->ecrites.load();
+                    }), tampons_.end());
+                }
+
+                lot_.clear();
+                fins_.clear();
+                std::uint64_t perdues = 0;
+                for (const auto& tampon : actifs_) {
+                    const std::uint64_t debut = tampon->lues.load(std::memory_order_relaxed);
+                    const std::uint64_t fin = tampon->ecrites.load(std::memory_order_acquire);
+                    fins_.push_back(fin);
+                    for (std::uint64_t i = debut; i < fin; ++i) {
+                        lot_.push_back({ tampon->numero, &tampon->emplacements[i % CAPACITE_TAMPON] });
+                    }
+                    perdues += tampon->perdues.exchange(0, std::memory_order_relaxed);
+                }
+                std::stable_sort(lot_.begin(), lot_.end(), [](const auto& a, const auto& b) {
+                    return a.second->horodatage < b.second->horodatage;
+                });
+
+                sortie_.clear();
+                erreurs_.clear();
+                for (const auto& [thread, emplacement] : lot_) {
+                    formater(emplacement->niveau >= NiveauTrace::Avertissement ? erreurs_ : sortie_,
+                        emplacement->horodatage, thread, emplacement->niveau,
+                        std::string_view(emplacement->texte, emplacement->taille));
+                }
+                if (perdues > 0) {
+                    std::string message = std::to_string(perdues) + " traces perdues (tampon de thread plein)";
+                    formater(erreurs_, horodatage(), 0, NiveauTrace::Avertissement, message);
+                }
+
+                // Les emplacements ne sont rendus aux producteurs qu'une fois recopiés
+                for (std::size_t i = 0; i < actifs_.size(); ++i) {
+                    actifs_[i]->lues.store(fins_[i], std::memory_order_release);
+                }
+                actifs_.clear();
+
+                ecrire(stdout, sortie_);
+                ecrire(stderr, erreurs_);
+            }
+
+        private:
+            std::mutex mutex_;           // tampons_, arret_
+            std::mutex vidage_mutex_;    // Un seul vidage à la fois (thread de fond ou vider())
+            std::condition_variable reveil_;
+            std::vector<std::shared_ptr<TamponThread>> tampons_;
+            std::uint32_t inscrits_ = 0;
+            bool arret_ = false;
+
+            // Réutilisés d'un lot à l'autre (sous vidage_mutex_)
+            std::vector<std::shared_ptr<TamponThread>> actifs_;
+            std::vector<std::pair<std::uint32_t, const Emplacement*>> lot_;
+            std::vector<std::uint64_t> fins_; // Fin lue de chaque tampon de actifs_
+            std::string sortie_;
+            std::string erreurs_;
+
+            std::thread thread_;
+
+            static void ecrire(std::FILE* flux, const std::string& texte) {
+                if (!texte.empty()) {
+                    std::fwrite(texte.data(), 1, texte.size(), flux);
+                    std::fflush(flux);
+                }
+            }
+
+            void boucle() {
+                std::unique_lock<std::mutex> verrou(mutex_);
+                while (!arret_) {
+                    reveil_.wait_for(verrou, std::chrono::milliseconds(10));
+                    verrou.unlock();
+                    vider();
+                    verrou.lock();
+                }
+                verrou.unlock();
+                vider();
+            }
+        };
+
+        Collecteur& collecteur() {
+            static Collecteur instance;
+            return instance;
+        }
+
+        // Inscription du thread courant ; le tampon survit au thread jusqu'à son vidage
+        struct InscriptionThread {
+            std::shared_ptr<TamponThread> tampon;
+            ~InscriptionThread() {
+                if (tampon) {
+                    tampon->termine = true;
+                }
+            }
+        };
+
+        thread_local InscriptionThread inscription;
+
+        // Emplacement d'une trace écrite sans passer par le collecteur (après son arrêt)
+        thread_local Emplacement secours;
+    }
+
+    namespace detail {
+        std::atomic<NiveauTrace> seuil{ niveauDepuisEnvironnement() };
+
+        Emplacement* reserver() {
+            if (collecteur_arrete.load(std::memory_order_relaxed)) {
+                return &secours;
+            }
+            if (!inscription.tampon) {
+                inscription.tampon = collecteur().inscrire();
+            }
+            TamponThread& tampon = *inscription.tampon;
+            const std::uint64_t ecrites = tampon.ecrites.load(std::memory_order_relaxed);
+            if (ecrites - tampon.lues.load(std::memory_order_acquire) >= CAPACITE_TAMPON) {
+                tampon.perdues.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            return &tampon.emplacements[ecrites % CAPACITE_TAMPON];
+        }
+
+        void publier(Emplacement& emplacement, NiveauTrace niveau, std::size_t taille) {
+            emplacement.horodatage = horodatage();
+            emplacement.niveau = niveau;
+            emplacement.taille = static_cast<std::uint16_t>(taille);
+            if (&emplacement == &secours) {
+                std::string ligne;
+                formater(ligne, emplacement.horodatage, 0, niveau, std::string_view(emplacement.texte, taille));
+                std::fwrite(ligne.data(), 1, ligne.size(), niveau >= NiveauTrace::Avertissement ? stderr : stdout);
+                return;
+            }
+            TamponThread& tampon = *inscription.tampon;
+            tampon.ecrites.store(tampon.ecrites.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        bool sensible(std::string_view nom) {
+            static constexpr std::string_view SENSIBLES[] = {
+                "password", "mot_de_passe", "password_hash", "token", "authorization", "cookie", "secret", "email"
+            };
+            return std::find(std::begin(SENSIBLES), std::end(SENSIBLES), nom) != std::end(SENSIBLES);
+        }
+    }
+
+    void definirNiveau(NiveauTrace niveau) {
+        detail::seuil.store(niveau, std::memory_order_relaxed);
+    }
+
+    void vider() {
+        if (!collecteur_arrete) {
+            collecteur().vider();
+        }
+    }
+
+} // namespace crowjourney::traces
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace crowjourney {
+
+    enum class NiveauTrace : std::uint8_t {
+        Debug,
+        Info,
+        Avertissement,
+        Erreur,
+        Aucun // Seuil seulement : désactive toutes les traces
+    };
+
+    // Traces structurées : un message suivi de champs nom=valeur, par exemple
+    //   TRACE_INFO("Inscription reçue", traces::champ("email", email), traces::champ("password", password));
+    // donne  2026-10-18T07:25:35.123Z INFO Inscription reçue email="a@x.fr" password="***"
+    //
+    // Chaque thread écrit dans son propre tampon circulaire (un producteur, un
+    // consommateur, sans verrou) ; un thread de fond les vide par lots, toutes les
+    // quelques millisecondes, en une seule écriture sur la sortie. Un thread de requête
+    // ne bloque donc jamais sur la sortie standard : si son tampon est plein, la trace
+    // est perdue et comptée. Les valeurs des champs sensibles (password, token,
+    // authorization, secret, email...) sont masquées quel que soit l'appelant.
+    //
+    // Le seuil se règle à l'exécution (definirNiveau, ou CROWJOURNEY_LOG_LEVEL=debug|info|
+    // avertissement|erreur au démarrage) ; TRACE_DEBUG disparaît des compilations NDEBUG.
+    namespace traces {
+
+        template <class T>
+        struct Champ {
+            std::string_view nom;
+            const T& valeur;
+        };
+
+        template <class T>
+        Champ<T> champ(std::string_view nom, const T& valeur) {
+            return { nom, valeur };
+        }
+
+        void definirNiveau(NiveauTrace niveau);
+
+        // Écrire tout de suite les traces en attente (avant un arrêt, par exemple)
+        void vider();
+
+        namespace detail {
+            constexpr std::size_t TAILLE_TEXTE = 240;
+
+            // Emplacement d'un tampon de thread : une trace déjà mise en forme
+            struct Emplacement {
+                std::int64_t horodatage; // Microsecondes depuis l'epoch
+                NiveauTrace niveau;
+                std::uint16_t taille;
+                char texte[TAILLE_TEXTE];
+            };
+
+            extern std::atomic<NiveauTrace> seuil;
+
+            // Prochain emplacement libre du tampon du thread ; nullptr s'il est plein
+            Emplacement* reserver();
+
+            // Rendre l'emplacement réservé visible du thread de vidage
+            void publier(Emplacement& emplacement, NiveauTrace niveau, std::size_t taille);
+
+            bool sensible(std::string_view nom);
+
+            // Mise en forme directe dans l'emplacement, tronquée à sa taille
+            class Ligne {
+            public:
+                explicit Ligne(Emplacement& emplacement) : emplacement_(emplacement) {}
+
+                void texte(std::string_view morceau) {
+                    std::size_t n = morceau.size() < TAILLE_TEXTE - taille_ ? morceau.size() : TAILLE_TEXTE - taille_;
+                    std::memcpy(emplacement_.texte + taille_, morceau.data(), n);
+                    taille_ += n;
+                }
+
+                template <class T>
+                void valeur(const T& v) {
+                    if constexpr (std::is_same_v<T, bool>) {
+                        texte(v ? "true" : "false");
+                    }
+                    else if constexpr (std::is_arithmetic_v<T>) {
+                        char tampon[32];
+                        auto [fin, erreur] = std::to_chars(tampon, tampon + sizeof(tampon), v);
+                        texte(std::string_view(tampon, erreur == std::errc() ? static_cast<std::size_t>(fin - tampon) : 0));
+                    }
+                    else {
+                        chaine(std::string_view(v));
+                    }
+                }
+
+                template <class T>
+                void ajouter(const Champ<T>& c) {
+                    texte(" ");
+                    texte(c.nom);
+                    texte("=");
+                    if (sensible(c.nom)) {
+                        texte("\"***\"");
+                    }
+                    else {
+                        valeur(c.valeur);
+                    }
+                }
+
+                std::size_t taille() const { return taille_; }
+
+            private:
+                Emplacement& emplacement_;
+                std::size_t taille_ = 0;
+
+                // Chaîne entre guillemets ; guillemets, barres obliques inverses et
+                // caractères de contrôle échappés pour garder une trace par ligne
+                void chaine(std::string_view s) {
+                    texte("\"");
+                    for (char c : s) {
+                        if (c == '"' || c == '\\') {
+                            char echappe[2] = { '\\', c };
+                            texte(std::string_view(echappe, 2));
+                        }
+                        else if (static_cast<unsigned char>(c) < 0x20) {
+                            texte(c == '\n' ? "\\n" : c == '\t' ? "\\t" : "?");
+                        }
+                        else {
+                            texte(std::string_view(&c, 1));
+                        }
+                    }
+                    texte("\"");
+                }
+            };
+        }
+
+        inline bool actif(NiveauTrace niveau) {
+            return niveau >= detail::seuil.load(std::memory_order_relaxed);
+        }
+
+        template <class... T>
+        void ecrire(NiveauTrace niveau, std::string_view message, const Champ<T>&... champs) {
+            detail::Emplacement* emplacement = detail::reserver();
+            if (!emplacement) {
+                return; // Tampon du thread plein : trace perdue (comptée)
+            }
+            detail::Ligne ligne(*emplacement);
+            ligne.texte(message);
+            (ligne.ajouter(champs), ...);
+            detail::publier(*emplacement, niveau, ligne.taille());
+        }
+
+    } // namespace traces
+
+} // namespace crowjourney
+
+#define CROWJOURNEY_TRACE(niveau, ...)                                                 \
+    do {                                                                               \
+        if (::crowjourney::traces::actif(niveau)) {                                    \
+            ::crowjourney::traces::ecrire(niveau, __VA_ARGS__);                        \
+        }                                                                              \
+    } while (0)
+
+#ifdef NDEBUG
+#define TRACE_DEBUG(...) do {} while (0)
+#else
+#define TRACE_DEBUG(...) CROWJOURNEY_TRACE(::crowjourney::NiveauTrace::Debug, __VA_ARGS__)
+#endif
+#define TRACE_INFO(...) CROWJOURNEY_TRACE(::crowjourney::NiveauTrace::Info, __VA_ARGS__)
+#define TRACE_AVERTISSEMENT(...) CROWJOURNEY_TRACE(::crowjourney::NiveauTrace::Avertissement, __VA_ARGS__)
+#define TRACE_ERREUR(...) CROWJOURNEY_TRACE(::crowjourney::NiveauTrace::Erreur, __VA_ARGS__)
@@ -1,9 +1,45 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Rôles d'un compte, en bits pour que les contrôles d'accès puissent en combiner plusieurs
+enum RoleUser : std::uint8_t {
+    ROLE_USER = 1u << 0,
+    ROLE_ADMIN = 1u << 1
+};
+
+// Nom du rôle aux frontières JSON (corps de requête, réponses, jeton)
+inline const char* nomRole(RoleUser role) {
+    return role == ROLE_ADMIN ? "admin" : "user";
+}
+
+inline std::optional<RoleUser> lireRole(std::string_view nom) {
+    if (nom == "user") return ROLE_USER;
+    if (nom == "admin") return ROLE_ADMIN;
+    return std::nullopt;
+}
+
+// Empreinte binaire du mot de passe (taille d'un condensat SHA-256)
+using EmpreinteMotDePasse = std::array<std::uint8_t, 32>;
+
+// Mot de passe dérivé par PBKDF2-HMAC-SHA256 avec un sel propre au compte.
+// iterations == 0 : empreinte héritée (std::hash, sans sel), encore acceptée à la connexion
+struct MotDePasseHache {
+    std::uint32_t iterations = 0;
+    std::array<std::uint8_t, 16> sel{};
+    EmpreinteMotDePasse empreinte{};
+};
+
+// Représentation interne compacte : rôle, date et mot de passe ne sont mis en forme
+// (nom, "%Y-%m-%d %H:%M:%S", "pbkdf2-sha256$...") qu'à la sérialisation JSON
 struct User {
     int id;
+    RoleUser role = ROLE_USER;
+    std::int64_t date_creation = 0;    // Secondes depuis l'epoch Unix
     std::string nom;
     std::string email;
-    std::string password_hash; // Mot de passe haché pour la sécurité
-    std::string role;          // Rôle facultatif (admin, user, etc.)
-    std::string date_creation; // Date de création du compte
+    MotDePasseHache password_hash{}; // Mot de passe haché pour la sécurité
 };
@@ -3,23 +3,144 @@
 #include <crow.h>
 #include <nlohmann/json.hpp>
 #include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <fstream>
 #include <regex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <filesystem>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
 #include "User.h"
 #include "Utils.h"
+#include "Journal.h"
+#include "SnapshotBinaire.h"
+#include "JsonWriter.h"
+#include "Metriques.h"
+#include "SchemaParser.h"
+#include "PoolCalcul.h"
+#include "Traces.h"
+#include "library.h" // App, AUTH_ENABLED et middlewares selon DISABLE_AUTH
 
-// Vérifier si l'authentification est désactivée
-#ifndef DISABLE_AUTH
-#include "JWTAuthMiddleware.h"
-#include "CookieParser.h"
-#include "CORSMiddleware.h"
-#define AUTH_ENABLED 1
+namespace crowjourney {
+
+    // Mise en forme des champs compacts de User aux frontières JSON (réponses, journal, import)
+
+    // Date locale "%Y-%m-%d %H:%M:%S" d'un horodatage epoch
+    std::string formaterDate(std::int64_t epoch) {
+        std::time_t instant = static_cast<std::time_t>(epoch);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &instant);
 #else
-#define AUTH_ENABLED 0
+        localtime_r(&instant, &local);
 #endif
+        char tampon[32];
+        std::size_t taille = std::strftime(tampon, sizeof(tampon), "%Y-%m-%d %H:%M:%S", &local);
+        return std::string(tampon, taille);
+    }
+
+    // Horodatage epoch d'une date locale "%Y-%m-%d %H:%M:%S" ; 0 si elle est mal formée
+    std::int64_t lireDate(const std::string& texte) {
+        std::tm local{};
+        std::istringstream flux(texte);
+        flux >> std::get_time(&local, "%Y-%m-%d %H:%M:%S");
+        if (flux.fail()) {
+            return 0;
+        }
+        local.tm_isdst = -1;
+        return static_cast<std::int64_t>(std::mktime(&local));
+    }
+
+    std::string octetsHex(const std::uint8_t* octets, std::size_t taille) {
+        static constexpr char CHIFFRES[] = "0123456789abcdef";
+        std::string texte(taille * 2, '0');
+        for (std::size_t i = 0; i < taille; ++i) {
+            texte[2 * i] = CHIFFRES[octets[i] >> 4];
+            texte[2 * i + 1] = CHIFFRES[octets[i] & 0x0F];
+        }
+        return texte;
+    }
+
+    // Lire exactement 2 * taille chiffres hexadécimaux ; false si le texte est mal formé
+    bool lireOctetsHex(std::string_view texte, std::uint8_t* octets, std::size_t taille) {
+        if (texte.size() != taille * 2) {
+            return false;
+        }
+        for (std::size_t i = 0; i < taille; ++i) {
+            auto [fin, erreur] = std::from_chars(texte.data() + 2 * i, texte.data() + 2 * i + 2, octets[i], 16);
+            if (erreur != std::errc() || fin != texte.data() + 2 * i + 2) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Préfixe des mots de passe dérivés : "pbkdf2-sha256$<itérations>$<sel hex>$<empreinte hex>"
+    constexpr std::string_view PREFIXE_PBKDF2 = "pbkdf2-sha256$";
+
+    std::string formaterMotDePasse(const MotDePasseHache& hache) {
+        std::string empreinte = octetsHex(hache.empreinte.data(), hache.empreinte.size());
+        if (hache.iterations == 0) {
+            return empreinte; // Empreinte héritée : hexadécimal seul, comme avant
+        }
+        std::string texte(PREFIXE_PBKDF2);
+        texte += std::to_string(hache.iterations);
+        texte += '$';
+        texte += octetsHex(hache.sel.data(), hache.sel.size());
+        texte += '$';
+        texte += empreinte;
+        return texte;
+    }
+
+    // Mot de passe lu sous sa forme texte. Sans préfixe, c'est une empreinte héritée :
+    // 64 chiffres, ou au plus 16 pour les comptes créés avant le format binaire
+    // (entier 64 bits, rangé dans les 8 premiers octets). Un texte mal formé donne
+    // une empreinte nulle, qui ne correspond à aucun mot de passe.
+    MotDePasseHache lireMotDePasse(std::string_view texte) {
+        MotDePasseHache hache;
+        if (texte.substr(0, PREFIXE_PBKDF2.size()) == PREFIXE_PBKDF2) {
+            texte.remove_prefix(PREFIXE_PBKDF2.size());
+            std::size_t dollar1 = texte.find('$');
+            std::size_t dollar2 = dollar1 == std::string_view::npos ? dollar1 : texte.find('$', dollar1 + 1);
+            std::uint32_t iterations = 0;
+            if (dollar2 == std::string_view::npos
+                || std::from_chars(texte.data(), texte.data() + dollar1, iterations).ptr != texte.data() + dollar1
+                || iterations == 0
+                || !lireOctetsHex(texte.substr(dollar1 + 1, dollar2 - dollar1 - 1), hache.sel.data(), hache.sel.size())
+                || !lireOctetsHex(texte.substr(dollar2 + 1), hache.empreinte.data(), hache.empreinte.size())) {
+                return MotDePasseHache{};
+            }
+            hache.iterations = iterations;
+        }
+        else if (texte.size() == hache.empreinte.size() * 2) {
+            if (!lireOctetsHex(texte, hache.empreinte.data(), hache.empreinte.size())) {
+                hache.empreinte = {};
+            }
+        }
+        else if (!texte.empty() && texte.size() <= 16) {
+            std::uint64_t valeur = 0;
+            auto [fin, erreur] = std::from_chars(texte.data(), texte.data() + texte.size(), valeur, 16);
+            if (erreur == std::errc() && fin == texte.data() + texte.size()) {
+                for (std::size_t i = 0; i < 8; ++i) {
+                    hache.empreinte[i] = static_cast<std::uint8_t>(valeur >> (56 - 8 * i));
+                }
+            }
+        }
+        return hache;
+    }
+
+} // namespace crowjourney
 
 // Conversion entre User et JSON
 namespace nlohmann {
@@ -30,9 +151,9 @@ namespace nlohmann {
                 {"id", user.id},
                 {"nom", user.nom},
                 {"email", user.email},
-                {"password_hash", user.password_hash},
-                {"role", user.role},
-                {"date_creation", user.date_creation}
+                {"password_hash", crowjourney::formaterMotDePasse(user.password_hash)},
+                {"role", nomRole(user.role)},
+                {"date_creation", crowjourney::formaterDate(user.date_creation)}
             };
         }
 
@@ -40,9 +161,10 @@ namespace nlohmann {
             j.at("id").get_to(user.id);
             j.at("nom").get_to(user.nom);
             j.at("email").get_to(user.email);
-            j.at("password_hash").get_to(user.password_hash);
-            j.at("role").get_to(user.role);
-            j.at("date_creation").get_to(user.date_creation);
+            user.password_hash = crowjourney::lireMotDePasse(j.at("password_hash").get_ref<const json::string_t&>());
+            // Un rôle inconnu (antérieur aux rôles typés) ne donne que les droits d'un utilisateur
+            user.role = lireRole(j.at("role").get_ref<const json::string_t&>()).value_or(ROLE_USER);
+            user.date_creation = crowjourney::lireDate(j.at("date_creation").get_ref<const json::string_t&>());
         }
     };
 }
@@ -51,14 +173,63 @@ using json = nlohmann::json;
 
 namespace crowjourney {
 
-    // Fonction utilitaire pour hasher un mot de passe avec SHA-256
-    std::string hashPassword(const std::string& password) {
-        // Solution temporaire - à remplacer par une méthode plus sécurisée
-        std::hash<std::string> hasher;
-        size_t hash = hasher(password);
-        std::stringstream ss;
-        ss << std::hex << hash;
-        return ss.str();
+    // Entier strictement positif lu dans une variable d'environnement (defaut si absente ou invalide)
+    std::size_t lireConfiguration(const char* nom, std::size_t defaut) {
+        const char* texte = std::getenv(nom);
+        std::size_t valeur = 0;
+        if (!texte || std::from_chars(texte, texte + std::strlen(texte), valeur).ec != std::errc() || valeur == 0) {
+            return defaut;
+        }
+        return valeur;
+    }
+
+    // Itérations PBKDF2 des nouveaux mots de passe (CROWJOURNEY_KDF_ITERATIONS). Chaque
+    // empreinte garde son propre nombre : le changer ne rend pas les comptes existants invalides.
+    std::uint32_t iterationsKdf() {
+        static const std::uint32_t iterations = static_cast<std::uint32_t>(
+            std::min<std::size_t>(lireConfiguration("CROWJOURNEY_KDF_ITERATIONS", 210000), std::numeric_limits<std::uint32_t>::max()));
+        return iterations;
+    }
+
+    // Dériver l'empreinte PBKDF2-HMAC-SHA256 d'un mot de passe (plusieurs dizaines de
+    // millisecondes : à appeler depuis le pool de hachage, pas depuis un thread de Crow)
+    EmpreinteMotDePasse deriver(const std::string& password, const MotDePasseHache& parametres) {
+        EmpreinteMotDePasse empreinte{};
+        if (PKCS5_PBKDF2_HMAC(password.data(), static_cast<int>(password.size()),
+                parametres.sel.data(), static_cast<int>(parametres.sel.size()),
+                static_cast<int>(parametres.iterations), EVP_sha256(),
+                static_cast<int>(empreinte.size()), empreinte.data()) != 1) {
+            throw std::runtime_error("Échec de la dérivation du mot de passe");
+        }
+        return empreinte;
+    }
+
+    // Empreinte des comptes créés avant PBKDF2 (std::hash, sans sel)
+    EmpreinteMotDePasse empreinteHeritee(const std::string& password) {
+        std::uint64_t hash = std::hash<std::string>{}(password);
+        EmpreinteMotDePasse empreinte{};
+        for (std::size_t i = 0; i < 8; ++i) {
+            empreinte[i] = static_cast<std::uint8_t>(hash >> (56 - 8 * i));
+        }
+        return empreinte;
+    }
+
+    // Hacher un nouveau mot de passe : sel aléatoire de 16 octets, PBKDF2-HMAC-SHA256
+    MotDePasseHache hashPassword(const std::string& password) {
+        MotDePasseHache hache;
+        hache.iterations = iterationsKdf();
+        if (RAND_bytes(hache.sel.data(), static_cast<int>(hache.sel.size())) != 1) {
+            throw std::runtime_error("Générateur aléatoire indisponible");
+        }
+        hache.empreinte = deriver(password, hache);
+        return hache;
+    }
+
+    // Comparer un mot de passe à son empreinte, en temps constant
+    bool verifierMotDePasse(const std::string& password, const MotDePasseHache& attendu) {
+        EmpreinteMotDePasse calculee = attendu.iterations == 0
+            ? empreinteHeritee(password) : deriver(password, attendu);
+        return CRYPTO_memcmp(calculee.data(), attendu.empreinte.data(), calculee.size()) == 0;
     }
 
     // Fonction utilitaire pour valider un email avec regex
@@ -86,152 +257,433 @@ namespace crowjourney {
         return hasUpper && hasLower && hasDigit;
     }
 
-    // Fonction pour obtenir la date et l'heure actuelles formatées
-    std::string getCurrentDateTime() {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    // Clé de l'index des emails : la casse n'est pas distinctive (Alice@X.fr == alice@x.fr)
+    std::string normaliserEmail(std::string_view email) {
+        std::string cle(email);
+        for (char& c : cle) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return cle;
+    }
+
+    // Horodatage epoch actuel
+    std::int64_t maintenant() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
 
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-        return ss.str();
+    // Champs des utilisateurs dans l'instantané binaire
+    namespace {
+        constexpr char TYPE_SNAPSHOT_USERS[5] = "USER";
+        constexpr std::uint32_t SCHEMA_USERS = 3;
+        enum ChampEntierUser : std::uint32_t {
+            USER_ID, USER_ROLE, USER_DATE_CREATION, USER_ITERATIONS, USER_NB_ENTIERS
+        };
+        enum ChampChaineUser : std::uint32_t {
+            USER_NOM, USER_EMAIL, USER_PASSWORD_HASH, USER_SEL, USER_NB_CHAINES // Empreinte et sel : octets bruts
+        };
+
+        // Schéma 2 : mêmes champs sans USER_ITERATIONS ni USER_SEL, lus comme absents
+        // (0 et chaîne vide), ce qui donne des empreintes héritées
+        constexpr std::uint32_t SCHEMA_USERS_V2 = 2;
+
+        // Schéma 1 : tous les champs sauf l'id en texte, relu pour migrer un instantané existant
+        constexpr std::uint32_t SCHEMA_USERS_V1 = 1;
+        enum ChampChaineUserV1 : std::uint32_t {
+            USER_V1_NOM, USER_V1_EMAIL, USER_V1_PASSWORD_HASH, USER_V1_ROLE, USER_V1_DATE_CREATION
+        };
     }
 
+    // Les handlers de Crow consultent les utilisateurs en parallèle : users_, ses index
+    // et next_id_ sont protégés par mutex_ (partagé en lecture, exclusif à la création).
+    // Les recherches renvoient des copies, jamais de pointeurs dans users_.
     class UserManager {
     private:
+        mutable std::shared_mutex mutex_;
         std::vector<User> users_;
+        std::unordered_map<std::string, std::size_t> par_email_; // Email normalisé -> position dans users_
+        std::unordered_map<int, std::size_t> par_id_;
         int next_id_;
-        std::string filename_; // Fichier pour sauvegarder les utilisateurs
+        std::string filename_;          // Format JSON (import au démarrage à défaut d'instantané binaire)
+        std::string snapshot_filename_; // Instantané binaire projeté en mémoire au démarrage
+
+        // Chaque création est ajoutée au journal ; l'instantané n'est réécrit
+        // qu'à la compaction, en arrière-plan
+        Journal journal_;
+        std::thread compaction_;
+        std::size_t seuil_compaction_;
+
+        // Écrire un instantané binaire (couvrant le journal jusqu'à sequence)
+        bool ecrireInstantane(const std::vector<User>& users, std::uint64_t sequence, int prochain_id) const {
+            metriques::Chrono chrono(metriques::Etape::EcritureInstantane);
+            EcrivainSnapshot ecrivain(TYPE_SNAPSHOT_USERS, SCHEMA_USERS, USER_NB_ENTIERS, USER_NB_CHAINES);
+            for (const auto& user : users) {
+                const MotDePasseHache& hache = user.password_hash;
+                ecrivain.ajouter({ user.id, user.role, user.date_creation, hache.iterations }, { user.nom, user.email,
+                    std::string_view(reinterpret_cast<const char*>(hache.empreinte.data()), hache.empreinte.size()),
+                    std::string_view(reinterpret_cast<const char*>(hache.sel.data()), hache.sel.size()) });
+            }
+            return ecrireFichierAtomique(snapshot_filename_, ecrivain.terminer(sequence, prochain_id));
+        }
+
+        // Charger l'instantané binaire ; false s'il est absent ou invalide
+        bool chargerInstantane(std::uint64_t& sequence) {
+            // Un instantané d'un schéma antérieur est réécrit au schéma courant par la prochaine compaction
+            SnapshotBinaire instantane;
+            std::uint32_t schema = 0;
+            if (!instantane.ouvrir(snapshot_filename_, TYPE_SNAPSHOT_USERS,
+                    { SCHEMA_USERS, SCHEMA_USERS_V2, SCHEMA_USERS_V1 }, schema)) {
+                return false;
+            }
+            const bool v1 = schema == SCHEMA_USERS_V1;
+
+            users_.clear();
+            users_.reserve(instantane.size());
+            for (std::size_t i = 0; i < instantane.size(); ++i) {
+                User user;
+                user.id = static_cast<int>(instantane.entier(i, USER_ID));
+                if (v1) {
+                    user.nom = instantane.chaine(i, USER_V1_NOM);
+                    user.email = instantane.chaine(i, USER_V1_EMAIL);
+                    user.password_hash = lireMotDePasse(instantane.chaine(i, USER_V1_PASSWORD_HASH));
+                    user.role = lireRole(instantane.chaine(i, USER_V1_ROLE)).value_or(ROLE_USER);
+                    user.date_creation = lireDate(std::string(instantane.chaine(i, USER_V1_DATE_CREATION)));
+                }
+                else {
+                    user.role = instantane.entier(i, USER_ROLE) == ROLE_ADMIN ? ROLE_ADMIN : ROLE_USER;
+                    user.date_creation = instantane.entier(i, USER_DATE_CREATION);
+                    user.nom = instantane.chaine(i, USER_NOM);
+                    user.email = instantane.chaine(i, USER_EMAIL);
+                    MotDePasseHache& hache = user.password_hash;
+                    hache.iterations = static_cast<std::uint32_t>(instantane.entier(i, USER_ITERATIONS));
+                    std::string_view empreinte = instantane.chaine(i, USER_PASSWORD_HASH);
+                    std::copy_n(empreinte.data(), std::min(empreinte.size(), hache.empreinte.size()),
+                        reinterpret_cast<char*>(hache.empreinte.data()));
+                    std::string_view sel = instantane.chaine(i, USER_SEL);
+                    std::copy_n(sel.data(), std::min(sel.size(), hache.sel.size()),
+                        reinterpret_cast<char*>(hache.sel.data()));
+                }
+                users_.push_back(std::move(user));
+            }
+            sequence = instantane.sequence();
+            next_id_ = std::max(next_id_, static_cast<int>(instantane.prochainId()));
+            return true;
+        }
+
+        // Importer l'ancien format JSON ; false si le fichier est absent ou illisible
+        bool importerJson(std::uint64_t& sequence) {
+            std::ifstream file(filename_);
+            if (!file.is_open()) {
+                return false;
+            }
+            try {
+                json data = json::parse(file);
+                users_ = data["users"].get<std::vector<User>>();
+                sequence = data.value("sequence", std::uint64_t{ 0 });
+                return true;
+            }
+            catch (const std::exception& e) {
+                TRACE_ERREUR("Erreur lors du chargement des utilisateurs", traces::champ("erreur", e.what()));
+                return false;
+            }
+        }
+
+        // Reconstruire les index après un chargement (le premier compte d'un email l'emporte)
+        void indexer() {
+            par_email_.clear();
+            par_id_.clear();
+            par_email_.reserve(users_.size());
+            par_id_.reserve(users_.size());
+            for (std::size_t i = 0; i < users_.size(); ++i) {
+                par_email_.try_emplace(normaliserEmail(users_[i].email), i);
+                par_id_.try_emplace(users_[i].id, i);
+            }
+        }
+
+        // Compacter le journal en arrière-plan à partir d'une copie des utilisateurs
+        // (appelé avec mutex_ verrouillé)
+        void lancerCompaction() {
+            if (!journal_.pivoter()) {
+                return; // Une compaction est déjà en cours
+            }
+            if (compaction_.joinable()) {
+                compaction_.join();
+            }
+
+            std::uint64_t sequence = journal_.derniereSequence();
+            compaction_ = std::thread([this, copie = users_, sequence, prochain_id = next_id_]() {
+                if (ecrireInstantane(copie, sequence, prochain_id)) {
+                    journal_.terminerCompaction();
+                }
+                else {
+                    journal_.abandonnerCompaction();
+                }
+            });
+        }
 
     public:
         // Constructeur
-        UserManager(const std::string& filename = "users.json") : next_id_(1), filename_(filename) {
+        UserManager(const std::string& filename = "users.json", std::size_t seuil_compaction = 1000)
+            : next_id_(1), filename_(filename),
+            snapshot_filename_(std::filesystem::path(filename).replace_extension(".snap").string()),
+            journal_(filename + ".journal"), seuil_compaction_(seuil_compaction) {
             loadUsers(); // Charger les utilisateurs depuis le fichier
         }
 
-        // Charger les utilisateurs depuis un fichier JSON
+        ~UserManager() {
+            if (compaction_.joinable()) {
+                compaction_.join();
+            }
+        }
+
+        // Charger les utilisateurs : instantané binaire (ou import JSON à défaut) puis relecture du journal
         void loadUsers() {
-            std::ifstream file(filename_);
-            if (file.is_open()) {
-                try {
-                    json data = json::parse(file);
-                    users_ = data["users"].get<std::vector<User>>();
+            std::unique_lock<std::shared_mutex> verrou(mutex_);
+            std::uint64_t sequence = 0;
+            bool depuis_json = !chargerInstantane(sequence) && importerJson(sequence);
 
-                    // Trouver le plus grand ID pour initialiser next_id_
-                    for (const auto& user : users_) {
-                        if (user.id >= next_id_) {
-                            next_id_ = user.id + 1;
+            try {
+                journal_.rejouer(sequence, [this](const json& enregistrement) {
+                    const std::string& op = enregistrement.at("op").get_ref<const json::string_t&>();
+                    if (op == "ecrire") {
+                        users_.push_back(enregistrement.at("user").get<User>());
+                    }
+                    else if (op == "role") {
+                        int id = enregistrement.at("id").get<int>();
+                        auto it = std::find_if(users_.begin(), users_.end(), [id](const User& user) { return user.id == id; });
+                        if (it != users_.end()) {
+                            it->role = lireRole(enregistrement.at("role").get_ref<const json::string_t&>()).value_or(ROLE_USER);
                         }
                     }
+                    else if (op == "mot_de_passe") {
+                        int id = enregistrement.at("id").get<int>();
+                        auto it = std::find_if(users_.begin(), users_.end(), [id](const User& user) { return user.id == id; });
+                        if (it != users_.end()) {
+                            it->password_hash = lireMotDePasse(enregistrement.at("password_hash").get_ref<const json::string_t&>());
+                        }
+                    }
+                });
+            }
+            catch (const ErreurJournal&) {
+                throw; // Journal corrompu : refuser de démarrer plutôt que de perdre des écritures
+            }
+            catch (const std::exception& e) {
+                TRACE_ERREUR("Erreur lors de la relecture du journal des utilisateurs", traces::champ("erreur", e.what()));
+            }
+            journal_.ouvrir();
+
+            // Trouver le plus grand ID pour initialiser next_id_
+            for (const auto& user : users_) {
+                if (user.id >= next_id_) {
+                    next_id_ = user.id + 1;
                 }
-                catch (const std::exception& e) {
-                    std::cerr << "Erreur lors du chargement des utilisateurs: " << e.what() << std::endl;
-                }
-                file.close();
+            }
+            indexer();
+            verrou.unlock();
+
+            // Terminer une compaction interrompue par un arrêt du serveur, ou produire
+            // l'instantané binaire après un import JSON pour accélérer le prochain démarrage
+            if (depuis_json || journal_.compactionInterrompue()) {
+                saveUsers();
             }
         }
 
-        // Sauvegarder les utilisateurs dans un fichier JSON
+        // Sauvegarder les utilisateurs : écrire immédiatement un instantané et vider le journal
         void saveUsers() {
-            json data;
-            data["users"] = users_;
-
-            std::ofstream file(filename_);
-            if (file.is_open()) {
-                file << data.dump(4); // Indentation de 4 espaces pour lisibilité
-                file.close();
+            std::shared_lock<std::shared_mutex> verrou(mutex_);
+            if (!journal_.pivoter()) {
+                return; // La compaction en cours écrit déjà l'instantané
+            }
+            if (ecrireInstantane(users_, journal_.derniereSequence(), next_id_)) {
+                journal_.terminerCompaction();
             }
             else {
-                std::cerr << "Impossible d'ouvrir le fichier pour sauvegarder les utilisateurs" << std::endl;
+                journal_.abandonnerCompaction();
             }
         }
 
         // Récupérer tous les utilisateurs (sans les mots de passe)
         std::vector<User> getUsers() const {
-            std::vector<User> safeUsers = users_;
+            std::vector<User> safeUsers;
+            {
+                std::shared_lock<std::shared_mutex> verrou(mutex_);
+                safeUsers = users_;
+            }
             for (auto& user : safeUsers) {
-                user.password_hash = ""; // Ne pas renvoyer les hash de mots de passe
+                user.password_hash = {}; // Ne pas renvoyer les hash de mots de passe
             }
             return safeUsers;
         }
 
-        // Trouver un utilisateur par email
-        User* getUserByEmail(const std::string& email) {
-            for (auto& user : users_) {
-                if (user.email == email) {
-                    return &user;
-                }
+        // Trouver un utilisateur par email (sans distinction de casse)
+        std::optional<User> getUserByEmail(const std::string& email) const {
+            const std::string cle = normaliserEmail(email);
+            std::shared_lock<std::shared_mutex> verrou(mutex_);
+            auto it = par_email_.find(cle);
+            if (it == par_email_.end()) {
+                return std::nullopt;
             }
-            return nullptr;
+            return users_[it->second];
         }
 
         // Trouver un utilisateur par ID
-        User* getUserById(int id) {
-            for (auto& user : users_) {
-                if (user.id == id) {
-                    return &user;
-                }
+        std::optional<User> getUserById(int id) const {
+            std::shared_lock<std::shared_mutex> verrou(mutex_);
+            auto it = par_id_.find(id);
+            if (it == par_id_.end()) {
+                return std::nullopt;
             }
-            return nullptr;
+            return users_[it->second];
         }
 
-        // Créer un nouvel utilisateur
+        // Créer un nouvel utilisateur, toujours avec le rôle user (seul changerRole
+        // attribue un autre rôle)
         std::pair<User, std::string> createUser(const std::string& nom, const std::string& email,
-            const std::string& password, const std::string& role = "user") {
+            const std::string& password, Acquittement mode = Acquittement::Durable) {
             // Valider l'email
             if (!isValidEmail(email)) {
                 return { User(), "Format d'email invalide" };
             }
 
-            // Vérifier si l'email existe déjà
-            if (getUserByEmail(email) != nullptr) {
-                return { User(), "Cet email est déjà utilisé" };
-            }
-
             // Valider le mot de passe
             if (!isStrongPassword(password)) {
                 return { User(), "Le mot de passe doit contenir au moins 8 caractères, une majuscule, une minuscule et un chiffre" };
             }
 
-            // Créer le nouvel utilisateur
+            // Écarter un email déjà pris avant de payer la dérivation du mot de passe
+            // (la vérification qui fait foi est refaite sous le verrou exclusif)
+            if (getUserByEmail(email)) {
+                return { User(), "Cet email est déjà utilisé" };
+            }
+
+            // Créer le nouvel utilisateur (le hachage se fait hors verrou)
             User newUser;
-            newUser.id = next_id_++;
             newUser.nom = nom;
             newUser.email = email;
             newUser.password_hash = hashPassword(password);
-            newUser.role = role;
-            newUser.date_creation = getCurrentDateTime();
+            newUser.role = ROLE_USER;
+            newUser.date_creation = maintenant();
+
+            std::uint64_t sequence = 0;
+            {
+                // Vérification de l'email et insertion sous le même verrou exclusif :
+                // deux inscriptions simultanées ne peuvent pas obtenir le même email
+                std::string cle = normaliserEmail(email);
+                std::unique_lock<std::shared_mutex> verrou(mutex_);
+                if (par_email_.count(cle) != 0) {
+                    return { User(), "Cet email est déjà utilisé" };
+                }
+                newUser.id = next_id_++;
 
-            users_.push_back(newUser);
+                // Journaliser la création puis la rendre visible
+                sequence = journal_.ajouter({ {"op", "ecrire"}, {"user", newUser} });
+                par_email_.emplace(std::move(cle), users_.size());
+                par_id_.emplace(newUser.id, users_.size());
+                users_.push_back(newUser);
 
-            // Sauvegarder les changements
-            saveUsers();
+                if (journal_.enregistrementsDepuisCompaction() >= seuil_compaction_) {
+                    lancerCompaction();
+                }
+            }
+            if (mode == Acquittement::Durable) {
+                journal_.attendreDurabilite(sequence);
+            }
 
             // Créer une copie sans mot de passe pour le retour
             User safeUser = newUser;
-            safeUser.password_hash = "";
+            safeUser.password_hash = {};
 
             return { safeUser, "Utilisateur créé avec succès" };
         }
 
-        // Convertir un utilisateur en JSON (sans le mot de passe)
-        json userToJson(const User& user) const {
-            return {
-                {"id", user.id},
-                {"nom", user.nom},
-                {"email", user.email},
-                {"role", user.role},
-                {"date_creation", user.date_creation}
-                // Ne pas inclure le password_hash !
-            };
+        // Écrire les champs d'un utilisateur dans l'objet JSON en cours (sans le mot de passe)
+        void ecrireUser(JsonWriter& sortie, const User& user) const {
+            sortie.champ("id", user.id)
+                .champ("nom", user.nom)
+                .champ("email", user.email)
+                .champ("role", nomRole(user.role))
+                .champ("date_creation", formaterDate(user.date_creation));
+            // Ne pas inclure le password_hash !
+        }
+
+        // Écrire la liste des utilisateurs sous forme de tableau JSON
+        void ecrireUsers(JsonWriter& sortie) const {
+            std::shared_lock<std::shared_mutex> verrou(mutex_);
+            sortie.debutTableau();
+            for (const auto& user : users_) {
+                sortie.debutObjet();
+                ecrireUser(sortie, user);
+                sortie.finObjet();
+            }
+            sortie.finTableau();
         }
 
-        // Authentifier un utilisateur avec email et mot de passe
-        User* authenticateUser(const std::string& email, const std::string& password) {
-            User* user = getUserByEmail(email);
-            if (user && user->password_hash == hashPassword(password)) {
-                return user;
+        // Changer le rôle d'un utilisateur ; nullopt s'il n'existe pas
+        std::optional<User> changerRole(int id, RoleUser role, Acquittement mode = Acquittement::Durable) {
+            User user;
+            std::uint64_t sequence = 0;
+            {
+                std::unique_lock<std::shared_mutex> verrou(mutex_);
+                auto it = par_id_.find(id);
+                if (it == par_id_.end()) {
+                    return std::nullopt;
+                }
+                sequence = journal_.ajouter({ {"op", "role"}, {"id", id}, {"role", nomRole(role)} });
+                users_[it->second].role = role;
+                user = users_[it->second];
+
+                if (journal_.enregistrementsDepuisCompaction() >= seuil_compaction_) {
+                    lancerCompaction();
+                }
             }
-            return nullptr;
+            if (mode == Acquittement::Durable) {
+                journal_.attendreDurabilite(sequence);
+            }
+            user.password_hash = {};
+            return user;
+        }
+
+        // Remplacer le mot de passe haché d'un utilisateur (journalisé sans attendre le disque)
+        void mettreAJourMotDePasse(int id, const MotDePasseHache& hache) {
+            std::unique_lock<std::shared_mutex> verrou(mutex_);
+            auto it = par_id_.find(id);
+            if (it == par_id_.end()) {
+                return;
+            }
+            journal_.ajouter({ {"op", "mot_de_passe"}, {"id", id}, {"password_hash", formaterMotDePasse(hache)} });
+            users_[it->second].password_hash = hache;
+
+            if (journal_.enregistrementsDepuisCompaction() >= seuil_compaction_) {
+                lancerCompaction();
+            }
+        }
+
+        // Authentifier un utilisateur avec email et mot de passe (dérivation PBKDF2 :
+        // à appeler depuis le pool de hachage)
+        std::optional<User> authenticateUser(const std::string& email, const std::string& password) {
+            std::optional<User> user = getUserByEmail(email);
+            if (!user) {
+                // Dériver quand même : la durée de la réponse ne révèle pas si l'email existe
+                static const MotDePasseHache fictif = [] {
+                    MotDePasseHache hache;
+                    hache.iterations = iterationsKdf();
+                    return hache;
+                }();
+                verifierMotDePasse(password, fictif);
+                return std::nullopt;
+            }
+            if (!verifierMotDePasse(password, user->password_hash)) {
+                return std::nullopt;
+            }
+
+            // Empreinte héritée : la remplacer par une dérivation PBKDF2 maintenant que le mot de passe est connu
+            if (user->password_hash.iterations == 0) {
+                user->password_hash = hashPassword(password);
+                mettreAJourMotDePasse(user->id, user->password_hash);
+            }
+            return user;
         }
     };
 
@@ -241,54 +693,117 @@ namespace crowjourney {
         return instance;
     }
 
+    void initialiserUtilisateurs() {
+        getUserManager();
+    }
+
+    // Pool de hachage des mots de passe, séparé des threads de Crow : CROWJOURNEY_KDF_THREADS
+    // threads (défaut : la moitié des cœurs) et au plus CROWJOURNEY_KDF_FILE tâches en attente
+    // (défaut : 64), au-delà desquelles /login et POST /users répondent 503
+    PoolCalcul& getPoolKdf() {
+        getUserManager(); // Construit avant le pool, donc détruit après lui : les tâches en file le trouvent intact
+        static PoolCalcul instance(
+            lireConfiguration("CROWJOURNEY_KDF_THREADS", std::max(1u, std::thread::hardware_concurrency() / 2)),
+            lireConfiguration("CROWJOURNEY_KDF_FILE", 64));
+        return instance;
+    }
+
+    // Terminer une réponse asynchrone (handlers dont le travail est confié au pool de hachage)
+    void terminerReponse(crow::response& res, int code, std::string corps) {
+        res.code = code;
+        res.body = std::move(corps);
+        res.add_header("Content-Type", "application/json; charset=utf-8");
+        res.end();
+    }
+
+    // File du pool de hachage pleine : refuser tout de suite plutôt que d'allonger l'attente
+    void refuserSurcharge(crow::response& res) {
+        res.add_header("Retry-After", "1");
+        terminerReponse(res, 503, R"({"error": "Serveur surchargé, réessayez dans un instant"})");
+    }
+
     // API Handlers pour les utilisateurs
 
-    // POST /users - Créer un nouvel utilisateur
-    crow::response registerUser(const crow::request& req) {
-        std::cout << "Requête d'enregistrement reçue: " << req.body << std::endl;
-        auto& userManager = getUserManager();
+    // Corps des requêtes d'inscription, de connexion et de changement de rôle.
+    // L'inscription ne connaît pas de champ role : un corps qui en contient un est refusé
+    // (champ inconnu), et le compte est toujours créé avec le rôle user
+    struct DemandeInscription {
+        std::optional<std::string> nom;
+        std::optional<std::string> email;
+        std::optional<std::string> password;
+    };
 
+    struct DemandeRole {
+        std::optional<std::string> role;
+    };
+
+    struct DemandeConnexion {
+        std::optional<std::string> email;
+        std::optional<std::string> password;
+    };
+
+    static const std::array<ChampSchema<DemandeInscription>, 3> SCHEMA_INSCRIPTION{ {
+        { "nom", &DemandeInscription::nom, 128 },
+        { "email", &DemandeInscription::email, 254 },
+        { "password", &DemandeInscription::password, 128 }
+    } };
+    static const std::array<ChampSchema<DemandeConnexion>, 2> SCHEMA_CONNEXION{ {
+        { "email", &DemandeConnexion::email, 254 },
+        { "password", &DemandeConnexion::password, 128 }
+    } };
+    static const std::array<ChampSchema<DemandeRole>, 1> SCHEMA_ROLE{ {
+        { "role", &DemandeRole::role, 32 }
+    } };
+
+    // POST /users - Créer un nouvel utilisateur. Le corps est validé sur le thread de Crow ;
+    // la dérivation du mot de passe et la création se font dans le pool de hachage,
+    // qui termine la réponse.
+    void registerUser(const crow::request& req, crow::response& res) {
         try {
-            auto body = json::parse(req.body);
+            DemandeInscription body = analyserCorps(req.body, SCHEMA_INSCRIPTION);
+            TRACE_DEBUG("Inscription reçue", traces::champ("nom", body.nom.value_or("")),
+                traces::champ("password", body.password.value_or("")));
 
             // Vérifier les champs obligatoires
-            if (!body.contains("nom") || !body.contains("email") || !body.contains("password")) {
-                auto response = crow::response(400, R"({"error": "Le nom, l'email et le mot de passe sont obligatoires"})");
-                response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
-                return std::move(response);
+            if (!body.nom || !body.email || !body.password) {
+                terminerReponse(res, 400, R"({"error": "Le nom, l'email et le mot de passe sont obligatoires"})");
+                return;
             }
 
-            std::string nom = body["nom"].get<std::string>();
-            std::string email = body["email"].get<std::string>();
-            std::string password = body["password"].get<std::string>();
-            std::string role = body.contains("role") ? body["role"].get<std::string>() : "user";
+            bool accepte = getPoolKdf().soumettre([&res, body = std::move(body), mode = modeAcquittement(req)]() {
+                try {
+                    auto& userManager = getUserManager();
 
-            // Créer l'utilisateur
-            auto [user, message] = userManager.createUser(nom, email, password, role);
+                    // Créer l'utilisateur
+                    auto [user, message] = userManager.createUser(*body.nom, *body.email, *body.password, mode);
 
-            if (user.id == 0) {
-                // Erreur lors de la création
-                auto response = crow::response(400, json{ {"error", message} }.dump());
-                response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
-                return std::move(response);
-            }
-
-            // Succès
-            json response_body = userManager.userToJson(user);
-            response_body["message"] = message;
+                    if (user.id == 0) {
+                        // Erreur lors de la création
+                        terminerReponse(res, 400, JsonWriter::objet("error", message));
+                        return;
+                    }
 
-            auto response = crow::response(201, response_body.dump());
-            response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
-            return std::move(response);
+                    // Succès
+                    JsonWriter sortie;
+                    sortie.debutObjet();
+                    userManager.ecrireUser(sortie, user);
+                    sortie.champ("message", message).finObjet();
+                    terminerReponse(res, 201, sortie.prendre());
+                }
+                catch (const ErreurJournal& e) {
+                    TRACE_ERREUR("Inscription non acquittée", traces::champ("erreur", e.what()));
+                    terminerReponse(res, 503, JsonWriter::objet("error", "Écriture appliquée mais pas encore confirmée sur disque : vérifier son état avant de la renvoyer"));
+                }
+                catch (const std::exception& e) {
+                    terminerReponse(res, 500, JsonWriter::objet("error", std::string("Erreur lors de la création: ") + e.what()));
+                }
+            });
+            if (!accepte) {
+                refuserSurcharge(res);
+            }
         }
         catch (const std::exception& e) {
-            auto response = crow::response(400, json{ {"error", std::string("Erreur de format JSON: ") + e.what()} }.dump());
-            response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
-            return std::move(response);
+            terminerReponse(res, 400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
         }
     }
 
@@ -296,147 +811,167 @@ namespace crowjourney {
     crow::response getAllUsers() {
         auto& userManager = getUserManager();
 
-        json result = json::array();
-        for (const auto& user : userManager.getUsers()) {
-            result.push_back(userManager.userToJson(user));
-        }
+        JsonWriter sortie(4096);
+        userManager.ecrireUsers(sortie);
 
-        auto response = crow::response(200, result.dump());
+        auto response = crow::response(200, sortie.prendre());
         response.add_header("Content-Type", "application/json; charset=utf-8");
-        addCorsHeaders(response);
         return std::move(response);
     }
 
-    // Gestionnaire pour les préflight OPTIONS (nécessaire pour CORS)
-    //crow::response handleUserOptions() {
-    //    auto response = crow::response(204);
-    //    response.add_header("Content-Type", "application/json; charset=utf-8");
-    //    addCorsHeaders(response);
-    //    return std::move(response);
-    //}
+    // PUT /users/id/role - Changer le rôle d'un utilisateur (admin) ; seule route qui
+    // attribue un rôle. Le jeton déjà émis garde l'ancien rôle jusqu'à son expiration.
+    crow::response changeUserRole(const crow::request& req, int id) {
+        try {
+            DemandeRole body = analyserCorps(req.body, SCHEMA_ROLE);
+            std::optional<RoleUser> role = body.role ? lireRole(*body.role) : std::nullopt;
+            if (!role) {
+                auto response = crow::response(400, JsonWriter::objet("error", "Rôle inconnu (user ou admin)"));
+                response.add_header("Content-Type", "application/json; charset=utf-8");
+                return std::move(response);
+            }
 
-    crow::response handleUserOptions() {
-        auto response = crow::response(204);
-        response.add_header("Content-Type", "application/json; charset=utf-8");
+            auto& userManager = getUserManager();
+            std::optional<User> user = userManager.changerRole(id, *role, modeAcquittement(req));
+            if (!user) {
+                auto response = crow::response(404, JsonWriter::objet("error", "Utilisateur non trouvé"));
+                response.add_header("Content-Type", "application/json; charset=utf-8");
+                return std::move(response);
+            }
 
-        std::cout << "AVANT addCorsHeaders dans OPTIONS: ";
-        for (const auto& header : response.headers) {
-            std::cout << header.first << "=" << header.second << "; ";
+            JsonWriter sortie;
+            sortie.debutObjet();
+            userManager.ecrireUser(sortie, *user);
+            sortie.champ("message", "Rôle mis à jour avec succès").finObjet();
+            auto response = crow::response(200, sortie.prendre());
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            return std::move(response);
         }
-        std::cout << std::endl;
-
-        addCorsHeaders(response);
-
-        std::cout << "APRÈS addCorsHeaders dans OPTIONS: ";
-        for (const auto& header : response.headers) {
-            std::cout << header.first << "=" << header.second << "; ";
+        catch (const ErreurJournal& e) {
+            TRACE_ERREUR("Changement de rôle non acquitté", traces::champ("erreur", e.what()));
+            auto response = crow::response(503, JsonWriter::objet("error", "Écriture appliquée mais pas encore confirmée sur disque : vérifier son état avant de la renvoyer"));
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            return std::move(response);
+        }
+        catch (const std::exception& e) {
+            auto response = crow::response(400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            return std::move(response);
         }
-        std::cout << std::endl;
-
-        return std::move(response);
     }
 
-    // Configuration des routes utilisateurs avec support pour les deux modes
-#if AUTH_ENABLED
-    void setup_user_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>& app) {
-        // Ajouter une route OPTIONS pour gérer les préflight CORS
-        CROW_ROUTE(app, "/users")
-            .methods(crow::HTTPMethod::OPTIONS)(handleUserOptions);
-#else
-    void setup_user_routes(crow::SimpleApp & app) {
-        // Ajouter une route OPTIONS pour gérer les préflight CORS
-        CROW_ROUTE(app, "/users")
-            .methods(crow::HTTPMethod::OPTIONS)(handleUserOptions);
-#endif
+    // Configuration des routes utilisateurs (identique dans les deux modes)
+    void setup_user_routes(App& app) {
         // POST /users - Créer un nouvel utilisateur
-        CROW_ROUTE(app, "/users")
-            .methods(crow::HTTPMethod::POST)(registerUser);
+        ROUTE_ACCES(app, "/users", crow::HTTPMethod::POST, ACCES_PUBLIC)(registerUser);
 
         // GET /users - Récupérer tous les utilisateurs (admin)
-        CROW_ROUTE(app, "/users")
-            .methods(crow::HTTPMethod::GET)(getAllUsers);
+        ROUTE_ACCES(app, "/users", crow::HTTPMethod::GET, ACCES_ADMIN)(getAllUsers);
+
+        // PUT /users/id/role - Changer le rôle d'un utilisateur (admin)
+        ROUTE_ACCES(app, "/users/<int>/role", crow::HTTPMethod::PUT, ACCES_ADMIN)(changeUserRole);
     }
 
     // Configuration des routes d'authentification avec support pour les deux modes
 #if AUTH_ENABLED
-    void setup_auth_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>&app, JWTAuthMiddleware & jwtMiddleware) {
-
-		// Ajouter une route OPTIONS pour gérer les préflight CORS
-		CROW_ROUTE(app, "/login")
-			.methods(crow::HTTPMethod::OPTIONS)(handleUserOptions);
-
-        CROW_ROUTE(app, "/login")
-            .methods(crow::HTTPMethod::POST)([&jwtMiddleware](const crow::request& req) {
-            auto& userManager = getUserManager();
-
+    void setup_auth_routes(App& app, JWTAuthMiddleware& jwtMiddleware) {
+        // Comme POST /users : la vérification du mot de passe passe par le pool de hachage
+        ROUTE_ACCES(app, "/login", crow::HTTPMethod::POST, ACCES_PUBLIC)([&jwtMiddleware](const crow::request& req, crow::response& res) {
             try {
-                auto body = json::parse(req.body);
+                DemandeConnexion body = analyserCorps(req.body, SCHEMA_CONNEXION);
 
                 // Vérifier les champs obligatoires
-                if (!body.contains("email") || !body.contains("password")) {
-                    auto response = crow::response(400, R"({"error": "L'email et le mot de passe sont obligatoires"})");
-                    response.add_header("Content-Type", "application/json; charset=utf-8");
-                    addCorsHeaders(response);
-                    return std::move(response);
+                if (!body.email || !body.password) {
+                    terminerReponse(res, 400, R"({"error": "L'email et le mot de passe sont obligatoires"})");
+                    return;
                 }
 
-                std::string email = body["email"].get<std::string>();
-                std::string password = body["password"].get<std::string>();
+                bool accepte = getPoolKdf().soumettre([&res, &jwtMiddleware, body = std::move(body)]() {
+                    try {
+                        auto& userManager = getUserManager();
 
-                // Authentifier l'utilisateur avec la fonction spécifique
-                User* user = userManager.authenticateUser(email, password);
-                if (!user) {
-                    auto response = crow::response(401, R"({"error": "Email ou mot de passe incorrect"})");
-                    response.add_header("Content-Type", "application/json; charset=utf-8");
-                    addCorsHeaders(response);
-                    return std::move(response);
-                }
+                        // Authentifier l'utilisateur avec la fonction spécifique
+                        std::optional<User> user = userManager.authenticateUser(*body.email, *body.password);
+                        if (!user) {
+                            terminerReponse(res, 401, R"({"error": "Email ou mot de passe incorrect"})");
+                            return;
+                        }
 
-                // Création du JWT avec l'instance passée en paramètre
-                std::string token = jwtMiddleware.generateToken(*user);
+                        // Création du JWT avec l'instance passée en paramètre
+                        std::string token = jwtMiddleware.generateToken(*user);
 
-                json response_body = {
-                    {"token", token},
-                    {"user", userManager.userToJson(*user)},
-                    {"message", "Connexion réussie"}
-                };
+                        JsonWriter sortie(token.size() + 256);
+                        sortie.debutObjet().champ("token", token).cle("user").debutObjet();
+                        userManager.ecrireUser(sortie, *user);
+                        sortie.finObjet().champ("message", "Connexion réussie").finObjet();
 
-                auto response = crow::response(200, response_body.dump());
-                response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
-                return std::move(response);
+                        // Le jeton reste dans le corps pour les clients qui l'envoient en en-tête
+                        std::string cookie = jwtMiddleware.cookieJeton(token);
+                        if (!cookie.empty()) {
+                            res.add_header("Set-Cookie", cookie);
+                        }
+                        terminerReponse(res, 200, sortie.prendre());
+                    }
+                    catch (const std::exception& e) {
+                        terminerReponse(res, 500, JsonWriter::objet("error", std::string("Erreur lors de la connexion: ") + e.what()));
+                    }
+                });
+                if (!accepte) {
+                    refuserSurcharge(res);
+                }
             }
             catch (const std::exception& e) {
-                auto response = crow::response(400, json{ {"error", std::string("Erreur de format JSON: ") + e.what()} }.dump());
-                response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
-                return std::move(response);
+                terminerReponse(res, 400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
             }
                 });
-#else
-    void setup_auth_routes(crow::SimpleApp & app) {
-        // Ajouter une route OPTIONS pour gérer les préflight CORS
-        CROW_ROUTE(app, "/login")
-            .methods(crow::HTTPMethod::OPTIONS)(handleUserOptions);
 
-        CROW_ROUTE(app, "/login")
-            .methods(crow::HTTPMethod::POST)([](const crow::request& req) {
-            // Mode développement: simuler une connexion réussie
-            json response_body = {
-                {"token", "dev-mode-token"},
-                {"user", {
-                    {"id", 1},
-                    {"nom", "Utilisateur de test"},
-                    {"email", "dev@example.com"},
-                    {"role", "admin"},
-                    {"date_creation", getCurrentDateTime()}
-                }},
-                {"message", "Connexion réussie (mode développement)"}
-            };
+        // POST /logout - Effacer le cookie de session (le navigateur ne peut pas le faire lui-même)
+        ROUTE_ACCES(app, "/logout", crow::HTTPMethod::POST, ACCES_PUBLIC)([&jwtMiddleware]() {
+            auto response = crow::response(204);
+            std::string cookie = jwtMiddleware.cookieJeton("");
+            if (!cookie.empty()) {
+                response.add_header("Set-Cookie", cookie);
+            }
+            return response;
+                });
 
-            auto response = crow::response(200, response_body.dump());
+        // GET /auth/cache - Efficacité du cache des jetons vérifiés
+        ROUTE_ACCES(app, "/auth/cache", crow::HTTPMethod::GET, ACCES_ADMIN)([&jwtMiddleware]() {
+            CacheJetons::Statistiques stats = jwtMiddleware.statistiquesCache();
+
+            JsonWriter sortie;
+            sortie.debutObjet()
+                .champ("entrees", stats.entrees)
+                .champ("capacite", stats.capacite)
+                .champ("succes", stats.succes)
+                .champ("echecs", stats.echecs)
+                .champ("evictions", stats.evictions)
+                .champ("taux_succes", stats.tauxSucces())
+                .finObjet();
+
+            auto response = crow::response(200, sortie.prendre());
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            return std::move(response);
+                });
+#else
+    void setup_auth_routes(App& app) {
+        ROUTE_ACCES(app, "/login", crow::HTTPMethod::POST, ACCES_PUBLIC)([](const crow::request& req) {
+            // Mode développement: simuler une connexion réussie
+            JsonWriter sortie;
+            sortie.debutObjet()
+                .champ("token", "dev-mode-token")
+                .cle("user").debutObjet()
+                    .champ("id", 1)
+                    .champ("nom", "Utilisateur de test")
+                    .champ("email", "dev@example.com")
+                    .champ("role", "admin")
+                    .champ("date_creation", formaterDate(maintenant()))
+                .finObjet()
+                .champ("message", "Connexion réussie (mode développement)")
+                .finObjet();
+
+            auto response = crow::response(200, sortie.prendre());
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
                 });
 #endif
@@ -1,10 +1,21 @@
 // Implémentation de la bibliothèque crowJourney
 #include "library.h"
 #include "Utils.h"
-#include <iostream>
 #include <algorithm>
 #include <stdexcept>
 #include <memory>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include "SnapshotBinaire.h"
+#include "JsonWriter.h"
+#include "Traces.h"
+#include "SchemaParser.h"
+#include "Metriques.h"
 
 // Implémentation de la sérialisation JSON pour Livre
 namespace nlohmann {
@@ -14,170 +25,551 @@ namespace nlohmann {
             j = json{
                 {"id", livre.id},
                 {"titre", livre.titre},
-                {"auteur", livre.auteur},
+                {"auteur", livre.auteur.vue()},
                 {"annee", livre.annee},
-                {"genre", livre.genre}
+                {"genre", livre.genre.vue()}
             };
         }
 
         static void from_json(const json& j, Livre& livre) {
             j.at("id").get_to(livre.id);
             j.at("titre").get_to(livre.titre);
-            j.at("auteur").get_to(livre.auteur);
+            livre.auteur = j.at("auteur").get_ref<const json::string_t&>();
             j.at("annee").get_to(livre.annee);
-            j.at("genre").get_to(livre.genre);
+            livre.genre = j.at("genre").get_ref<const json::string_t&>();
         }
     };
 }
 
 namespace crowjourney {
 
+    namespace {
+        // Identifiant aléatoire propre à ce processus : après un redémarrage, la même
+        // version du catalogue ne doit pas produire un ETag déjà vu par un client
+        std::string identifiantInstance() {
+            std::random_device alea;
+            std::stringstream ss;
+            ss << std::hex << ((static_cast<std::uint64_t>(alea()) << 32) | alea());
+            return ss.str();
+        }
+
+        // Nombre d'auteurs de top_auteurs dans GET /books/stats
+        constexpr std::size_t TOP_AUTEURS_DEFAUT = 10;
+        constexpr std::size_t TOP_AUTEURS_MAX = 100;
+    }
+
     // Constructeur de BibliothequeManager
-    BibliothequeManager::BibliothequeManager(const std::string& filename)
-        : next_id_(4), filename_(filename) {
+    BibliothequeManager::BibliothequeManager(const std::string& filename, std::size_t seuil_compaction)
+        : instance_(identifiantInstance()), next_id_(4), filename_(filename),
+        snapshot_filename_(std::filesystem::path(filename).replace_extension(".snap").string()),
+        journal_(filename + ".journal"),
+        seuil_compaction_(seuil_compaction) {
         // Initialisation des livres par défaut
-        livres_ = {
+        auto initial = std::make_shared<CatalogueSnapshot>();
+        for (Livre livre : std::vector<Livre>{
             {"Le Petit Prince", "Antoine de Saint-Exupéry", 1943, "Fiction", 1},
             {"L'Étranger", "Albert Camus", 1942, "Philosophie", 2},
             {"Les Misérables", "Victor Hugo", 1862, "Roman historique", 3}
-        };
+        }) {
+            initial->livres.assign(livre.id, std::move(livre));
+        }
+        catalogue_.store(std::move(initial));
 
         // Essayer de charger depuis le fichier (si existe)
         loadBooks();
     }
 
-    // Sauvegarder les livres dans un fichier JSON
-    void BibliothequeManager::saveBooks() {
-        json data;
-        data["livres"] = livres_;
+    BibliothequeManager::~BibliothequeManager() {
+        if (compaction_.joinable()) {
+            compaction_.join();
+        }
+    }
+
+    // Publier une nouvelle version du catalogue
+    void BibliothequeManager::publier(std::shared_ptr<CatalogueSnapshot> suivant) {
+        suivant->version = catalogue_.load()->version + 1;
+        catalogue_.store(std::move(suivant));
+    }
 
-        std::ofstream file(filename_, std::ios::binary);
-        if (file.is_open()) {
-            file << data.dump(4);
-            file.close();
+    // Appliquer un enregistrement du journal à un catalogue en cours de chargement
+    void BibliothequeManager::appliquer(CatalogueSnapshot& catalogue, const json& enregistrement) {
+        const std::string op = enregistrement.at("op").get<std::string>();
+        if (op == "ecrire") {
+            Livre livre = enregistrement.at("livre").get<Livre>();
+            if (!SlotMap<Livre>::idValide(livre.id)) {
+                TRACE_AVERTISSEMENT("Enregistrement du journal ignoré, id hors limites", traces::champ("id", livre.id));
+                return;
+            }
+            if (livre.id >= next_id_) {
+                next_id_ = livre.id + 1;
+            }
+            catalogue.livres.assign(livre.id, std::move(livre));
         }
-        else {
-            std::cerr << "Impossible d'ouvrir le fichier pour sauvegarder les livres" << std::endl;
+        else if (op == "supprimer") {
+            catalogue.livres.erase(enregistrement.at("id").get<int>());
         }
     }
 
-    // Charger les livres depuis un fichier JSON
-    void BibliothequeManager::loadBooks() {
-        std::ifstream file(filename_, std::ios::binary);
-        if (file.is_open()) {
-            try {
-                json data = json::parse(file);
-                if (data.contains("livres")) {
-                    livres_ = data["livres"].get<std::vector<Livre>>();
+    // Champs des livres dans l'instantané binaire
+    namespace {
+        constexpr char TYPE_SNAPSHOT_LIVRES[5] = "LIVR";
+        constexpr std::uint32_t SCHEMA_LIVRES = 1;
+        enum ChampEntierLivre : std::uint32_t { LIVRE_ID, LIVRE_ANNEE, LIVRE_NB_ENTIERS };
+        enum ChampChaineLivre : std::uint32_t { LIVRE_TITRE, LIVRE_AUTEUR, LIVRE_GENRE, LIVRE_NB_CHAINES };
+    }
+
+    // Écrire un instantané binaire du catalogue (couvrant le journal jusqu'à sequence)
+    bool BibliothequeManager::ecrireInstantane(const CatalogueSnapshot& catalogue, std::uint64_t sequence, int prochain_id) const {
+        metriques::Chrono chrono(metriques::Etape::EcritureInstantane);
+        EcrivainSnapshot ecrivain(TYPE_SNAPSHOT_LIVRES, SCHEMA_LIVRES, LIVRE_NB_ENTIERS, LIVRE_NB_CHAINES);
+        for (const auto& livre : catalogue.livres) {
+            ecrivain.ajouter({ livre.id, livre.annee }, { livre.titre, livre.auteur, livre.genre });
+        }
+        return ecrireFichierAtomique(snapshot_filename_, ecrivain.terminer(sequence, prochain_id));
+    }
+
+    // Charger l'instantané binaire ; false s'il est absent ou invalide
+    bool BibliothequeManager::chargerInstantane(CatalogueSnapshot& catalogue, std::uint64_t& sequence) {
+        SnapshotBinaire instantane;
+        if (!instantane.ouvrir(snapshot_filename_, TYPE_SNAPSHOT_LIVRES, SCHEMA_LIVRES)) {
+            return false;
+        }
 
+        catalogue.livres = SlotMap<Livre>();
+        for (std::size_t i = 0; i < instantane.size(); ++i) {
+            Livre livre;
+            livre.id = static_cast<int>(instantane.entier(i, LIVRE_ID));
+            livre.annee = static_cast<int>(instantane.entier(i, LIVRE_ANNEE));
+            livre.titre = instantane.chaine(i, LIVRE_TITRE);
+            livre.auteur = instantane.chaine(i, LIVRE_AUTEUR);
+            livre.genre = instantane.chaine(i, LIVRE_GENRE);
+            if (!SlotMap<Livre>::idValide(livre.id)) {
+                TRACE_AVERTISSEMENT("Livre de l'instantané ignoré, id hors limites", traces::champ("id", livre.id));
+                continue;
+            }
+            if (livre.id >= next_id_) {
+                next_id_ = livre.id + 1;
+            }
+            catalogue.livres.assign(livre.id, std::move(livre));
+        }
+        sequence = instantane.sequence();
+        next_id_ = std::max(next_id_, static_cast<int>(instantane.prochainId()));
+        return true;
+    }
+
+    // Importer l'ancien format JSON ; false si le fichier est absent ou illisible
+    bool BibliothequeManager::importerJson(CatalogueSnapshot& catalogue, std::uint64_t& sequence) {
+        std::ifstream file(filename_, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        try {
+            json data = json::parse(file);
+            if (data.contains("livres")) {
+                catalogue.livres = SlotMap<Livre>();
+                for (auto& entree : data["livres"]) {
+                    Livre livre = entree.get<Livre>();
+                    if (!SlotMap<Livre>::idValide(livre.id)) {
+                        TRACE_AVERTISSEMENT("Livre importé ignoré, id hors limites", traces::champ("id", livre.id));
+                        continue;
+                    }
                     // Trouver le plus grand ID
-                    for (const auto& livre : livres_) {
-                        if (livre.id >= next_id_) {
-                            next_id_ = livre.id + 1;
-                        }
+                    if (livre.id >= next_id_) {
+                        next_id_ = livre.id + 1;
                     }
+                    catalogue.livres.assign(livre.id, std::move(livre));
                 }
             }
-            catch (const std::exception& e) {
-                std::cerr << "Erreur lors du chargement des livres: " << e.what() << std::endl;
+            sequence = data.value("sequence", std::uint64_t{ 0 });
+            next_id_ = std::max(next_id_, data.value("prochain_id", 0));
+            return true;
+        }
+        catch (const std::exception& e) {
+            TRACE_ERREUR("Erreur lors du chargement des livres", traces::champ("erreur", e.what()));
+            return false;
+        }
+    }
+
+    // Compacter le journal en arrière-plan (appelé avec ecriture_mutex_ verrouillé)
+    void BibliothequeManager::lancerCompaction() {
+        if (!journal_.pivoter()) {
+            return; // Une compaction est déjà en cours
+        }
+        if (compaction_.joinable()) {
+            compaction_.join();
+        }
+
+        auto instantane = catalogue_.load();
+        std::uint64_t sequence = journal_.derniereSequence();
+        int prochain_id = next_id_;
+        compaction_ = std::thread([this, instantane, sequence, prochain_id]() {
+            if (ecrireInstantane(*instantane, sequence, prochain_id)) {
+                journal_.terminerCompaction();
             }
-            file.close();
+            else {
+                journal_.abandonnerCompaction();
+            }
+        });
+    }
+
+    // Enregistrer une mutation dans le journal puis publier la nouvelle version
+    // et mettre à jour les index (avant/apres : état du livre modifié, nul s'il est absent)
+    std::uint64_t BibliothequeManager::valider(json enregistrement, std::shared_ptr<CatalogueSnapshot> suivant,
+        const Livre* avant, const Livre* apres) {
+        std::uint64_t sequence = journal_.ajouter(std::move(enregistrement));
+        {
+            std::unique_lock<std::shared_mutex> verrou(index_mutex_);
+            index_.remplacer(avant, apres);
+            recherche_.remplacer(avant, apres);
+            suggestions_.remplacer(avant, apres);
+            colonnes_.remplacer(avant, apres);
+            statistiques_.remplacer(avant, apres);
+            publier(std::move(suivant));
+        }
+
+        if (journal_.enregistrementsDepuisCompaction() >= seuil_compaction_) {
+            lancerCompaction();
         }
+        return sequence;
     }
 
-    // Récupérer tous les livres
-    const std::vector<Livre>& BibliothequeManager::getTousLivres() const {
-        return livres_;
+    // Attendre, selon le mode demandé, que la mutation soit sur disque (hors verrou d'écriture)
+    void BibliothequeManager::acquitter(std::uint64_t sequence, Acquittement mode) {
+        if (mode == Acquittement::Durable) {
+            journal_.attendreDurabilite(sequence);
+        }
     }
 
-    // Récupérer un livre par son ID
-    Livre* BibliothequeManager::getLivreParId(int id) {
-        for (auto& livre : livres_) {
-            if (livre.id == id) {
-                return &livre;
+    // Charger les livres : instantané binaire (ou import JSON à défaut) puis relecture du journal
+    void BibliothequeManager::loadBooks() {
+        std::lock_guard<std::mutex> verrou(ecriture_mutex_);
+        auto charge = std::make_shared<CatalogueSnapshot>(*catalogue_.load());
+        std::uint64_t sequence = 0;
+
+        bool depuis_json = !chargerInstantane(*charge, sequence) && importerJson(*charge, sequence);
+
+        try {
+            journal_.rejouer(sequence, [this, &charge](const json& enregistrement) {
+                appliquer(*charge, enregistrement);
+            });
+        }
+        catch (const ErreurJournal&) {
+            throw; // Journal corrompu : refuser de démarrer plutôt que de perdre des écritures
+        }
+        catch (const std::exception& e) {
+            TRACE_ERREUR("Erreur lors de la relecture du journal des livres", traces::champ("erreur", e.what()));
+        }
+        {
+            std::unique_lock<std::shared_mutex> verrou_index(index_mutex_);
+            index_.vider();
+            recherche_.vider();
+            suggestions_.commencerChargement();
+            colonnes_.vider();
+            statistiques_.vider();
+            for (const auto& livre : charge->livres) {
+                index_.ajouter(livre);
+                recherche_.ajouter(livre);
+                suggestions_.ajouter(livre);
+                colonnes_.ajouter(livre);
+                statistiques_.ajouter(livre);
+            }
+            suggestions_.terminerChargement();
+            publier(std::move(charge));
+        }
+        journal_.ouvrir();
+
+        // Terminer une compaction interrompue par un arrêt du serveur, ou produire
+        // l'instantané binaire après un import JSON pour accélérer le prochain démarrage
+        if ((depuis_json || journal_.compactionInterrompue()) && journal_.pivoter()) {
+            if (ecrireInstantane(*catalogue_.load(), journal_.derniereSequence(), next_id_)) {
+                journal_.terminerCompaction();
+            }
+            else {
+                journal_.abandonnerCompaction();
+            }
+        }
+    }
+
+    // Récupérer la version courante du catalogue
+    std::shared_ptr<const CatalogueSnapshot> BibliothequeManager::getCatalogue() const {
+        return catalogue_.load();
+    }
+
+    // Corps de GET /books pour la version courante du catalogue
+    std::shared_ptr<const CorpsCatalogue> BibliothequeManager::getCorpsCatalogue() const {
+        auto catalogue = catalogue_.load();
+        auto cache = corps_cache_.load();
+        if (cache && cache->version == catalogue->version) {
+            return cache;
+        }
+
+        // Sérialisation hors verrou ; si plusieurs threads la font en parallèle,
+        // le cache ne revient jamais à une version plus ancienne
+        metriques::Chrono chrono(metriques::Etape::Serialisation);
+        JsonWriter sortie(catalogue->livres.size() * 128 + 2);
+        sortie.debutTableau();
+        for (const auto& livre : catalogue->livres) {
+            sortie.debutObjet();
+            ecrireLivre(sortie, livre);
+            sortie.finObjet();
+        }
+        sortie.finTableau();
+
+        auto nouveau = std::make_shared<CorpsCatalogue>();
+        nouveau->version = catalogue->version;
+        nouveau->corps = sortie.prendre();
+        nouveau->etag = "\"" + instance_ + "-" + std::to_string(catalogue->version) + "\"";
+
+        std::shared_ptr<const CorpsCatalogue> publie = nouveau;
+        while (!(cache && cache->version >= publie->version)
+            && !corps_cache_.compare_exchange_weak(cache, publie)) {
+        }
+        return publie;
+    }
+
+    // Corps de GET /books/stats : les compteurs et la version sont lus ensemble sous le verrou d'index
+    std::shared_ptr<const CorpsStatistiques> BibliothequeManager::getCorpsStatistiques(std::size_t top) const {
+        const bool par_defaut = top == TOP_AUTEURS_DEFAUT;
+        auto cache = statistiques_cache_.load();
+        if (par_defaut && cache && cache->version == catalogue_.load()->version) {
+            return cache;
+        }
+
+        auto nouveau = std::make_shared<CorpsStatistiques>();
+        JsonWriter sortie(1024 + top * 64);
+        {
+            std::shared_lock<std::shared_mutex> verrou(index_mutex_);
+            nouveau->version = catalogue_.load()->version;
+            statistiques_.ecrire(sortie, top);
+        }
+        nouveau->top = top;
+        nouveau->corps = sortie.prendre();
+        nouveau->etag = "\"" + instance_ + "-" + std::to_string(nouveau->version) + "-s" + std::to_string(top) + "\"";
+
+        std::shared_ptr<const CorpsStatistiques> publie = nouveau;
+        while (par_defaut && !(cache && cache->version >= publie->version)
+            && !statistiques_cache_.compare_exchange_weak(cache, publie)) {
+        }
+        return publie;
+    }
+
+    // Livres d'une page de GET /books, sérialisés directement depuis la version courante
+    int BibliothequeManager::ecrirePage(JsonWriter& sortie, const RequetePage& page) const {
+        metriques::Chrono chrono(metriques::Etape::Serialisation);
+        std::size_t ecrits = 0;
+        int dernier = 0;
+        bool suite = false;
+        auto ecrire = [&](const Livre& livre) {
+            if (ecrits == page.limite) {
+                suite = true; // Au moins un livre de plus : la page suivante existe
+                return false;
+            }
+            sortie.debutObjet();
+            ecrireLivre(sortie, livre, page.champs);
+            sortie.finObjet();
+            dernier = livre.id;
+            ++ecrits;
+            return true;
+        };
+
+        sortie.debutTableau();
+        if (!page.filtre.actif()) {
+            auto catalogue = catalogue_.load();
+            for (auto it = catalogue->livres.lower_bound(page.apres + 1); it != catalogue->livres.end() && ecrire(*it); ++it) {
+            }
+        }
+        else {
+            // L'index et la version lus ensemble sont cohérents ; les critères qui n'ont pas
+            // guidé le parcours sont vérifiés sur chaque livre candidat
+            std::shared_lock<std::shared_mutex> verrou(index_mutex_);
+            auto catalogue = catalogue_.load();
+            index_.parcourir(page.filtre, page.apres, [&](int id) {
+                const Livre* livre = catalogue->livres.find(id);
+                return !livre || !page.filtre.accepte(*livre) || ecrire(*livre);
+            });
+        }
+        sortie.finTableau();
+        return suite ? dernier : 0;
+    }
+
+    // Résultats de GET /books/search, lus avec la version correspondant à l'index
+    void BibliothequeManager::ecrireRecherche(JsonWriter& sortie, std::string_view requete, std::size_t limite) const {
+        std::shared_lock<std::shared_mutex> verrou(index_mutex_);
+        auto catalogue = catalogue_.load();
+        auto resultats = recherche_.rechercher(requete, limite);
+        verrou.unlock();
+
+        sortie.debutTableau();
+        for (const auto& resultat : resultats) {
+            if (const Livre* livre = catalogue->livres.find(resultat.id)) {
+                sortie.debutObjet();
+                ecrireLivre(sortie, *livre);
+                sortie.champ("score", resultat.score).finObjet();
             }
         }
-        return nullptr;
+        sortie.finTableau();
+    }
+
+    // Résultat de GET /books/count
+    void BibliothequeManager::ecrireComptage(JsonWriter& sortie, const FiltreLivres& filtre, bool par_decennie) const {
+        std::shared_lock<std::shared_mutex> verrou(index_mutex_);
+        const std::size_t total = colonnes_.compter(filtre);
+        std::vector<std::pair<int, std::size_t>> decennies;
+        if (par_decennie) {
+            decennies = colonnes_.compterParDecennie(filtre);
+        }
+        verrou.unlock();
+
+        sortie.debutObjet().champ("total", static_cast<std::uint64_t>(total));
+        if (par_decennie) {
+            sortie.cle("par_decennie").debutTableau();
+            for (const auto& [decennie, livres] : decennies) {
+                sortie.debutObjet()
+                    .champ("decennie", decennie)
+                    .champ("livres", static_cast<std::uint64_t>(livres))
+                    .finObjet();
+            }
+            sortie.finTableau();
+        }
+        sortie.finObjet();
+    }
+
+    // Résultats de GET /books/suggest
+    void BibliothequeManager::ecrireSuggestions(JsonWriter& sortie, std::string_view saisie, std::size_t limite) const {
+        std::shared_lock<std::shared_mutex> verrou(index_mutex_);
+        auto resultats = suggestions_.suggerer(saisie, limite);
+        verrou.unlock();
+
+        sortie.debutTableau();
+        for (const auto& resultat : resultats) {
+            sortie.debutObjet()
+                .champ("texte", resultat.texte)
+                .champ("type", resultat.auteur ? "auteur" : "titre")
+                .champ("livres", static_cast<std::uint64_t>(resultat.livres))
+                .champ("distance", static_cast<std::uint64_t>(resultat.distance))
+                .finObjet();
+        }
+        sortie.finTableau();
+    }
+
+    // Récupérer un livre par son ID
+    std::optional<Livre> BibliothequeManager::getLivreParId(int id) const {
+        auto catalogue = catalogue_.load();
+        if (const Livre* livre = catalogue->livres.find(id)) {
+            return *livre;
+        }
+        return std::nullopt;
     }
 
     // Ajouter un nouveau livre
     Livre BibliothequeManager::ajouterLivre(const std::string& titre, const std::string& auteur,
-        int annee, const std::string& genre) {
+        int annee, const std::string& genre, Acquittement mode) {
+        std::unique_lock<std::mutex> verrou(ecriture_mutex_);
+
         Livre nouveau_livre;
-        nouveau_livre.id = next_id_++;
+        nouveau_livre.id = next_id_;
         nouveau_livre.titre = titre;
         nouveau_livre.auteur = auteur;
         nouveau_livre.annee = annee;
         nouveau_livre.genre = genre;
 
-        livres_.push_back(nouveau_livre);
+        auto suivant = std::make_shared<CatalogueSnapshot>(*catalogue_.load());
+        suivant->livres.assign(nouveau_livre.id, nouveau_livre); // std::out_of_range au-delà de ID_MAX
+        ++next_id_;
 
-        // Sauvegarder les livres après ajout
-        saveBooks();
+        // Journaliser l'ajout puis le rendre visible
+        std::uint64_t sequence = valider({ {"op", "ecrire"}, {"livre", nouveau_livre} }, std::move(suivant),
+            nullptr, &nouveau_livre);
+        verrou.unlock();
+        acquitter(sequence, mode);
 
         return nouveau_livre;
     }
 
     // Mettre à jour un livre
-    bool BibliothequeManager::mettreAJourLivre(int id, const json& donnees) {
-        for (auto& livre : livres_) {
-            if (livre.id == id) {
-                if (donnees.contains("titre")) {
-                    livre.titre = donnees["titre"].get<std::string>();
-                }
-                if (donnees.contains("auteur")) {
-                    livre.auteur = donnees["auteur"].get<std::string>();
-                }
-                if (donnees.contains("annee")) {
-                    livre.annee = donnees["annee"].get<int>();
-                }
-                if (donnees.contains("genre")) {
-                    livre.genre = donnees["genre"].get<std::string>();
-                }
+    std::optional<Livre> BibliothequeManager::mettreAJourLivre(int id, const LivreMaj& maj, Acquittement mode) {
+        std::unique_lock<std::mutex> verrou(ecriture_mutex_);
 
-                // Sauvegarder les livres après mise à jour
-                saveBooks();
+        auto courant = catalogue_.load();
+        const Livre* existant = courant->livres.find(id);
+        if (!existant) {
+            return std::nullopt;
+        }
 
-                return true;
-            }
+        Livre livre = *existant;
+        if (maj.titre) {
+            livre.titre = *maj.titre;
         }
-        return false;
+        if (maj.auteur) {
+            livre.auteur = *maj.auteur;
+        }
+        if (maj.annee) {
+            livre.annee = *maj.annee;
+        }
+        if (maj.genre) {
+            livre.genre = *maj.genre;
+        }
+
+        auto suivant = std::make_shared<CatalogueSnapshot>(*courant);
+        suivant->livres.assign(id, livre);
+
+        // Journaliser la mise à jour puis la rendre visible
+        std::uint64_t sequence = valider({ {"op", "ecrire"}, {"livre", livre} }, std::move(suivant),
+            existant, &livre);
+        verrou.unlock();
+        acquitter(sequence, mode);
+
+        return livre;
     }
 
     // Supprimer un livre
-    bool BibliothequeManager::supprimerLivre(int id) {
-        auto it = std::find_if(livres_.begin(), livres_.end(),
-            [id](const Livre& livre) { return livre.id == id; });
+    bool BibliothequeManager::supprimerLivre(int id, Acquittement mode) {
+        std::unique_lock<std::mutex> verrou(ecriture_mutex_);
 
-        if (it != livres_.end()) {
-            livres_.erase(it);
-            saveBooks();
-            return true;
+        auto courant = catalogue_.load();
+        const Livre* existant = courant->livres.find(id);
+        if (!existant) {
+            return false;
         }
-        return false;
+
+        auto suivant = std::make_shared<CatalogueSnapshot>(*courant);
+        suivant->livres.erase(id);
+        std::uint64_t sequence = valider({ {"op", "supprimer"}, {"id", id} }, std::move(suivant),
+            existant, nullptr);
+        verrou.unlock();
+        acquitter(sequence, mode);
+        return true;
     }
 
     // Mettre à jour uniquement le titre d'un livre
-    bool BibliothequeManager::mettreAJourTitre(int id, const std::string& nouveauTitre) {
-        for (auto& livre : livres_) {
-            if (livre.id == id) {
-                livre.titre = nouveauTitre;
-                saveBooks();
-                return true;
-            }
+    std::optional<Livre> BibliothequeManager::mettreAJourTitre(int id, const std::string& nouveauTitre, Acquittement mode) {
+        std::unique_lock<std::mutex> verrou(ecriture_mutex_);
+
+        auto courant = catalogue_.load();
+        const Livre* existant = courant->livres.find(id);
+        if (!existant) {
+            return std::nullopt;
         }
-        return false;
+
+        Livre livre = *existant;
+        livre.titre = nouveauTitre;
+
+        auto suivant = std::make_shared<CatalogueSnapshot>(*courant);
+        suivant->livres.assign(id, livre);
+        std::uint64_t sequence = valider({ {"op", "ecrire"}, {"livre", livre} }, std::move(suivant),
+            existant, &livre);
+        verrou.unlock();
+        acquitter(sequence, mode);
+        return livre;
     }
 
-    // Conversion d'un livre en JSON
-    json BibliothequeManager::livreToJson(const Livre& livre) const {
-        return {
-            {"id", livre.id},
-            {"titre", livre.titre},
-            {"auteur", livre.auteur},
-            {"annee", livre.annee},
-            {"genre", livre.genre}
-        };
+    // Écrire les champs d'un livre dans l'objet JSON en cours
+    void BibliothequeManager::ecrireLivre(JsonWriter& sortie, const Livre& livre, unsigned champs) const {
+        if (champs & CHAMP_ID) sortie.champ("id", livre.id);
+        if (champs & CHAMP_TITRE) sortie.champ("titre", livre.titre);
+        if (champs & CHAMP_AUTEUR) sortie.champ("auteur", livre.auteur);
+        if (champs & CHAMP_ANNEE) sortie.champ("annee", livre.annee);
+        if (champs & CHAMP_GENRE) sortie.champ("genre", livre.genre);
     }
 
     // Utilisation d'un singleton pour la gestion de la bibliothèque
@@ -188,16 +580,328 @@ namespace crowjourney {
 
     // Gestionnaires de requêtes pour les routes
 
-    // GET /books - Récupérer tous les livres
-    crow::response getAllBooks() {
+    // Schémas des corps de requête (POST/PUT /books, PATCH /books/id/titre)
+    static const std::array<ChampSchema<LivreMaj>, 4> SCHEMA_LIVRE{ {
+        { "titre", &LivreMaj::titre, 512 },
+        { "auteur", &LivreMaj::auteur, 256 },
+        { "annee", &LivreMaj::annee },
+        { "genre", &LivreMaj::genre, 128 }
+    } };
+    static const std::array<ChampSchema<LivreMaj>, 1> SCHEMA_TITRE{ {
+        { "titre", &LivreMaj::titre, 512 }
+    } };
+
+    // Vérifier si l'en-tête If-None-Match désigne l'ETag courant (liste séparée par des virgules)
+    static bool etagCorrespond(const std::string& if_none_match, const std::string& etag) {
+        std::size_t pos = 0;
+        while (pos < if_none_match.size()) {
+            std::size_t fin = if_none_match.find(',', pos);
+            if (fin == std::string::npos) {
+                fin = if_none_match.size();
+            }
+            std::size_t debut = if_none_match.find_first_not_of(" \t", pos);
+            std::size_t dernier = if_none_match.find_last_not_of(" \t", fin - 1);
+            if (debut != std::string::npos && debut < fin && dernier >= debut) {
+                std::string candidat = if_none_match.substr(debut, dernier - debut + 1);
+                // If-None-Match utilise la comparaison faible : le préfixe W/ est ignoré
+                if (candidat.rfind("W/", 0) == 0) {
+                    candidat.erase(0, 2);
+                }
+                if (candidat == "*" || candidat == etag) {
+                    return true;
+                }
+            }
+            pos = fin + 1;
+        }
+        return false;
+    }
+
+    // Limite de taille d'une page de GET /books
+    static constexpr std::size_t LIMITE_PAGE_MAX = 1000;
+
+    // Lire un paramètre entier de l'URL compris entre minimum et maximum ; false s'il est mal formé
+    static bool lireEntierParametre(const char* texte, long long minimum, long long maximum, long long& valeur) {
+        std::string_view vue(texte);
+        auto [fin, erreur] = std::from_chars(vue.data(), vue.data() + vue.size(), valeur);
+        return erreur == std::errc() && fin == vue.data() + vue.size() && valeur >= minimum && valeur <= maximum;
+    }
+
+    // Analyser fields=titre,auteur en masque de ChampLivre ; 0 si un nom est inconnu
+    static unsigned lireChamps(std::string_view liste) {
+        unsigned champs = 0;
+        while (!liste.empty()) {
+            std::size_t fin = std::min(liste.find(','), liste.size());
+            std::string_view nom = liste.substr(0, fin);
+            if (nom == "id") champs |= CHAMP_ID;
+            else if (nom == "titre") champs |= CHAMP_TITRE;
+            else if (nom == "auteur") champs |= CHAMP_AUTEUR;
+            else if (nom == "annee") champs |= CHAMP_ANNEE;
+            else if (nom == "genre") champs |= CHAMP_GENRE;
+            else return 0;
+            liste.remove_prefix(std::min(fin + 1, liste.size()));
+        }
+        return champs;
+    }
+
+    // Lire les critères auteur, genre, annee_min et annee_max ; renvoie le message d'erreur, vide si valides
+    static std::string lireFiltre(const crow::request& req, FiltreLivres& filtre) {
+        if (const char* auteur = req.url_params.get("auteur")) {
+            filtre.auteur = auteur;
+        }
+        if (const char* genre = req.url_params.get("genre")) {
+            filtre.genre = genre;
+        }
+        long long valeur = 0;
+        if (const char* annee_min = req.url_params.get("annee_min")) {
+            if (!lireEntierParametre(annee_min, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), valeur)) {
+                return "Paramètre 'annee_min' invalide";
+            }
+            filtre.annee_min = static_cast<int>(valeur);
+        }
+        if (const char* annee_max = req.url_params.get("annee_max")) {
+            if (!lireEntierParametre(annee_max, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), valeur)) {
+                return "Paramètre 'annee_max' invalide";
+            }
+            filtre.annee_max = static_cast<int>(valeur);
+        }
+        return {};
+    }
+
+    static crow::response erreurParametre(const std::string& message) {
+        auto response = crow::response(400, JsonWriter::objet("error", message));
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        return std::move(response);
+    }
+
+    // Mutation appliquée en mémoire mais pas confirmée sur disque (mode durable) : 503,
+    // sans Retry-After. Elle est déjà visible et le journal la retente : la renvoyer
+    // telle quelle (POST /books) créerait un doublon
+    static crow::response erreurJournal(const ErreurJournal& e) {
+        TRACE_ERREUR("Écriture non acquittée", traces::champ("erreur", e.what()));
+        auto response = crow::response(503, JsonWriter::objet("error", "Écriture appliquée mais pas encore confirmée sur disque : vérifier son état avant de la renvoyer"));
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        return std::move(response);
+    }
+
+    // Auteur et genre du corps, internés d'avance ; false si l'un est nouveau et que le
+    // pool des chaînes internées est plein (il ne libère jamais une valeur)
+    static bool admettreValeurs(const LivreMaj& body) {
+        return (!body.auteur || ChaineInternee::admettre(*body.auteur))
+            && (!body.genre || ChaineInternee::admettre(*body.genre));
+    }
+
+    static crow::response refuserValeurs() {
+        TRACE_AVERTISSEMENT("Pool des chaînes internées plein, nouvel auteur ou genre refusé");
+        auto response = crow::response(507, JsonWriter::objet("error", "Trop d'auteurs ou de genres distincts, limite du serveur atteinte"));
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        return std::move(response);
+    }
+
+    // GET /books - Récupérer tous les livres.
+    // Avec limit et/ou cursor, renvoie une page {"livres": [...], "next_cursor": id|null} ;
+    // fields=titre,auteur restreint les champs de chaque livre ;
+    // auteur, genre, annee_min et annee_max filtrent via les index secondaires.
+    crow::response getAllBooks(const crow::request& req) {
         auto& biblio = getBibliotheque();
-        json result = json::array();
-        for (const auto& livre : biblio.getTousLivres()) {
-            result.push_back(biblio.livreToJson(livre));
+
+        const char* limit = req.url_params.get("limit");
+        const char* cursor = req.url_params.get("cursor");
+        const char* fields = req.url_params.get("fields");
+        const char* auteur = req.url_params.get("auteur");
+        const char* genre = req.url_params.get("genre");
+        const char* annee_min = req.url_params.get("annee_min");
+        const char* annee_max = req.url_params.get("annee_max");
+        if (limit || cursor || fields || auteur || genre || annee_min || annee_max) {
+            RequetePage page;
+            page.limite = std::numeric_limits<std::size_t>::max();
+            long long valeur = 0;
+            if (limit) {
+                if (!lireEntierParametre(limit, 1, LIMITE_PAGE_MAX, valeur)) {
+                    return erreurParametre("Paramètre 'limit' invalide (entier entre 1 et "
+                        + std::to_string(LIMITE_PAGE_MAX) + ")");
+                }
+                page.limite = static_cast<std::size_t>(valeur);
+            }
+            else if (cursor) {
+                page.limite = RequetePage{}.limite;
+            }
+            if (cursor) {
+                if (!lireEntierParametre(cursor, 0, std::numeric_limits<int>::max() - 1, valeur)) {
+                    return erreurParametre("Paramètre 'cursor' invalide");
+                }
+                page.apres = static_cast<int>(valeur);
+            }
+            if (fields) {
+                page.champs = lireChamps(fields);
+                if (page.champs == 0) {
+                    return erreurParametre("Paramètre 'fields' invalide (id, titre, auteur, annee, genre)");
+                }
+            }
+            std::string erreur = lireFiltre(req, page.filtre);
+            if (!erreur.empty()) {
+                return erreurParametre(erreur);
+            }
+
+            // Pagination : enveloppe avec curseur ; sinon tableau, comme sans paramètre
+            const bool pagine = limit || cursor;
+            JsonWriter sortie(pagine ? page.limite * 128 + 64 : 4096);
+            if (pagine) {
+                sortie.debutObjet().cle("livres");
+            }
+            int suivant = biblio.ecrirePage(sortie, page);
+            if (pagine) {
+                sortie.cle("next_cursor");
+                if (suivant != 0) {
+                    sortie.valeur(suivant);
+                }
+                else {
+                    sortie.valeurNulle(); // Dernière page
+                }
+                sortie.finObjet();
+            }
+
+            auto response = crow::response(200, sortie.prendre());
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            response.add_header("Cache-Control", "no-cache");
+            return std::move(response);
         }
-        auto response = crow::response(200, result.dump());
+
+        auto cache = biblio.getCorpsCatalogue();
+
+        // Le client possède déjà cette version : 304 sans corps
+        if (etagCorrespond(req.get_header_value("If-None-Match"), cache->etag)) {
+            auto response = crow::response(304);
+            response.add_header("ETag", cache->etag);
+            response.add_header("Cache-Control", "no-cache");
+            return std::move(response);
+        }
+
+        auto response = crow::response(200, cache->corps);
         response.add_header("Content-Type", "application/json; charset=utf-8");
-        addCorsHeaders(response);
+        response.add_header("ETag", cache->etag);
+        response.add_header("Cache-Control", "no-cache");
+        return std::move(response);
+    }
+
+    // GET /books/count - Nombre de livres satisfaisant les critères auteur, genre,
+    // annee_min et annee_max ; par=decennie ajoute la répartition par décennie.
+    // Calculé par balayage de la copie en colonnes du catalogue.
+    crow::response countBooks(const crow::request& req) {
+        auto& biblio = getBibliotheque();
+
+        FiltreLivres filtre;
+        std::string erreur = lireFiltre(req, filtre);
+        if (!erreur.empty()) {
+            return erreurParametre(erreur);
+        }
+        bool par_decennie = false;
+        if (const char* par = req.url_params.get("par")) {
+            if (std::string_view(par) != "decennie") {
+                return erreurParametre("Paramètre 'par' invalide (decennie)");
+            }
+            par_decennie = true;
+        }
+
+        JsonWriter sortie(par_decennie ? 4096 : 32);
+        biblio.ecrireComptage(sortie, filtre, par_decennie);
+
+        auto response = crow::response(200, sortie.prendre());
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        response.add_header("Cache-Control", "no-cache");
+        return std::move(response);
+    }
+
+    // GET /books/stats?top=N - Totaux par genre et par décennie, et les N auteurs les plus représentés
+    crow::response getBookStats(const crow::request& req) {
+        auto& biblio = getBibliotheque();
+
+        std::size_t top = TOP_AUTEURS_DEFAUT;
+        if (const char* parametre = req.url_params.get("top")) {
+            long long valeur = 0;
+            if (!lireEntierParametre(parametre, 0, TOP_AUTEURS_MAX, valeur)) {
+                return erreurParametre("Paramètre 'top' invalide (entier entre 0 et "
+                    + std::to_string(TOP_AUTEURS_MAX) + ")");
+            }
+            top = static_cast<std::size_t>(valeur);
+        }
+
+        auto cache = biblio.getCorpsStatistiques(top);
+        if (etagCorrespond(req.get_header_value("If-None-Match"), cache->etag)) {
+            auto response = crow::response(304);
+            response.add_header("ETag", cache->etag);
+            response.add_header("Cache-Control", "no-cache");
+            return std::move(response);
+        }
+
+        auto response = crow::response(200, cache->corps);
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        response.add_header("ETag", cache->etag);
+        response.add_header("Cache-Control", "no-cache");
+        return std::move(response);
+    }
+
+    // Nombre de résultats de GET /books/search
+    static constexpr std::size_t LIMITE_RECHERCHE_DEFAUT = 20;
+    static constexpr std::size_t LIMITE_RECHERCHE_MAX = 100;
+
+    // GET /books/search?q=...&limit=N - Recherche plein texte sur le titre et l'auteur
+    crow::response searchBooks(const crow::request& req) {
+        auto& biblio = getBibliotheque();
+
+        const char* q = req.url_params.get("q");
+        if (!q || !*q) {
+            return erreurParametre("Le paramètre 'q' est obligatoire");
+        }
+        if (std::strlen(q) > 512) {
+            return erreurParametre("Paramètre 'q' trop long (512 octets maximum)");
+        }
+        std::size_t limite = LIMITE_RECHERCHE_DEFAUT;
+        if (const char* limit = req.url_params.get("limit")) {
+            long long valeur = 0;
+            if (!lireEntierParametre(limit, 1, LIMITE_RECHERCHE_MAX, valeur)) {
+                return erreurParametre("Paramètre 'limit' invalide (entier entre 1 et "
+                    + std::to_string(LIMITE_RECHERCHE_MAX) + ")");
+            }
+            limite = static_cast<std::size_t>(valeur);
+        }
+
+        JsonWriter sortie(limite * 160 + 2);
+        biblio.ecrireRecherche(sortie, q, limite);
+
+        auto response = crow::response(200, sortie.prendre());
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        response.add_header("Cache-Control", "no-cache");
+        return std::move(response);
+    }
+
+    // Nombre de suggestions de GET /books/suggest
+    static constexpr std::size_t LIMITE_SUGGESTIONS_DEFAUT = 8;
+    static constexpr std::size_t LIMITE_SUGGESTIONS_MAX = 50;
+
+    // GET /books/suggest?prefix=...&limit=N - Complétion des titres et auteurs, tolérante aux fautes de frappe
+    crow::response suggestBooks(const crow::request& req) {
+        auto& biblio = getBibliotheque();
+
+        const char* prefix = req.url_params.get("prefix");
+        if (!prefix) {
+            return erreurParametre("Le paramètre 'prefix' est obligatoire");
+        }
+        std::size_t limite = LIMITE_SUGGESTIONS_DEFAUT;
+        if (const char* limit = req.url_params.get("limit")) {
+            long long valeur = 0;
+            if (!lireEntierParametre(limit, 1, LIMITE_SUGGESTIONS_MAX, valeur)) {
+                return erreurParametre("Paramètre 'limit' invalide (entier entre 1 et "
+                    + std::to_string(LIMITE_SUGGESTIONS_MAX) + ")");
+            }
+            limite = static_cast<std::size_t>(valeur);
+        }
+
+        JsonWriter sortie(limite * 96 + 2);
+        biblio.ecrireSuggestions(sortie, prefix, limite);
+
+        auto response = crow::response(200, sortie.prendre());
+        response.add_header("Content-Type", "application/json; charset=utf-8");
+        response.add_header("Cache-Control", "no-cache");
         return std::move(response);
     }
 
@@ -205,39 +909,45 @@ namespace crowjourney {
     crow::response addBook(const crow::request& req) {
         auto& biblio = getBibliotheque();
         try {
-            auto body = json::parse(req.body);
+            LivreMaj body = analyserCorps(req.body, SCHEMA_LIVRE);
 
             // Vérification des champs obligatoires
-            if (!body.contains("titre") || !body.contains("auteur")) {
+            if (!body.titre || !body.auteur) {
                 auto response = crow::response(400, R"({"error": "Le titre et l'auteur sont obligatoires"})");
                 response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
                 return std::move(response);
             }
+            if (!admettreValeurs(body)) {
+                return refuserValeurs();
+            }
 
             // Extraction des données
-            std::string titre = body["titre"].get<std::string>();
-            std::string auteur = body["auteur"].get<std::string>();
-            int annee = body.contains("annee") ? body["annee"].get<int>() : 0;
-            std::string genre = body.contains("genre") ? body["genre"].get<std::string>() : "";
-
             // Ajout du livre
-            Livre nouveau_livre = biblio.ajouterLivre(titre, auteur, annee, genre);
+            Livre nouveau_livre = biblio.ajouterLivre(*body.titre, *body.auteur,
+                body.annee.value_or(0), body.genre.value_or(""), modeAcquittement(req));
 
             // Préparation de la réponse
-            json response_body = biblio.livreToJson(nouveau_livre);
-            response_body["message"] = "Livre ajouté avec succès";
+            JsonWriter sortie;
+            sortie.debutObjet();
+            biblio.ecrireLivre(sortie, nouveau_livre);
+            sortie.champ("message", "Livre ajouté avec succès").finObjet();
 
-            auto response = crow::response(201, response_body.dump());
+            auto response = crow::response(201, sortie.prendre());
+            response.add_header("Content-Type", "application/json; charset=utf-8");
+            return std::move(response);
+        }
+        catch (const ErreurJournal& e) {
+            return erreurJournal(e);
+        }
+        catch (const std::out_of_range& e) {
+            TRACE_ERREUR("Identifiants de livres épuisés", traces::champ("erreur", e.what()));
+            auto response = crow::response(507, JsonWriter::objet("error", "Nombre maximal de livres atteint"));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
         catch (const std::exception& e) {
-            json error = { {"error", std::string("Erreur de format JSON: ") + e.what()} };
-            auto response = crow::response(400, error.dump());
+            auto response = crow::response(400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
     }
@@ -245,18 +955,18 @@ namespace crowjourney {
     // GET /books/id - Récupérer un livre spécifique par ID
     crow::response getBookById(int id) {
         auto& biblio = getBibliotheque();
-        Livre* livre = biblio.getLivreParId(id);
+        auto livre = biblio.getLivreParId(id);
         if (livre) {
-            json result = biblio.livreToJson(*livre);
-            auto response = crow::response(200, result.dump());
+            JsonWriter sortie;
+            sortie.debutObjet();
+            biblio.ecrireLivre(sortie, *livre);
+            sortie.finObjet();
+            auto response = crow::response(200, sortie.prendre());
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
-        json error = { {"error", "Livre non trouvé"} };
-        auto response = crow::response(404, error.dump());
+        auto response = crow::response(404, JsonWriter::objet("error", "Livre non trouvé"));
         response.add_header("Content-Type", "application/json; charset=utf-8");
-        addCorsHeaders(response);
         return std::move(response);
     }
 
@@ -264,51 +974,57 @@ namespace crowjourney {
     crow::response updateBook(const crow::request& req, int id) {
         auto& biblio = getBibliotheque();
         try {
-            auto body = json::parse(req.body);
-
-            if (biblio.mettreAJourLivre(id, body)) {
-                Livre* livre = biblio.getLivreParId(id);
-                if (livre) {
-                    json result = biblio.livreToJson(*livre);
-                    result["message"] = "Livre mis à jour avec succès";
-                    auto response = crow::response(200, result.dump());
-                    response.add_header("Content-Type", "application/json; charset=utf-8");
-                    addCorsHeaders(response);
-                    return std::move(response);
-                }
+            LivreMaj body = analyserCorps(req.body, SCHEMA_LIVRE);
+            if (!admettreValeurs(body)) {
+                return refuserValeurs();
+            }
+
+            auto livre = biblio.mettreAJourLivre(id, body, modeAcquittement(req));
+            if (livre) {
+                JsonWriter sortie;
+                sortie.debutObjet();
+                biblio.ecrireLivre(sortie, *livre);
+                sortie.champ("message", "Livre mis à jour avec succès").finObjet();
+                auto response = crow::response(200, sortie.prendre());
+                response.add_header("Content-Type", "application/json; charset=utf-8");
+                return std::move(response);
             }
-            json error = { {"error", "Livre non trouvé"} };
-            auto response = crow::response(404, error.dump());
+            auto response = crow::response(404, JsonWriter::objet("error", "Livre non trouvé"));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
+        catch (const ErreurJournal& e) {
+            return erreurJournal(e);
+        }
         catch (const std::exception& e) {
-            json error = { {"error", std::string("Erreur de format JSON: ") + e.what()} };
-            auto response = crow::response(400, error.dump());
+            auto response = crow::response(400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
     }
 
     // DELETE /books/id - Supprimer un livre spécifique
-    crow::response deleteBook(int id) {
+    crow::response deleteBook(const crow::request& req, int id) {
         auto& biblio = getBibliotheque();
-        if (biblio.supprimerLivre(id)) {
-            json result = {
-                {"message", "Livre supprimé avec succès"},
-                {"id", id}
-            };
-            auto response = crow::response(200, result.dump());
+        bool supprime;
+        try {
+            supprime = biblio.supprimerLivre(id, modeAcquittement(req));
+        }
+        catch (const ErreurJournal& e) {
+            return erreurJournal(e);
+        }
+        if (supprime) {
+            JsonWriter sortie(64);
+            sortie.debutObjet()
+                .champ("message", "Livre supprimé avec succès")
+                .champ("id", id)
+                .finObjet();
+            auto response = crow::response(200, sortie.prendre());
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
-        json error = { {"error", "Livre non trouvé"} };
-        auto response = crow::response(404, error.dump());
+        auto response = crow::response(404, JsonWriter::objet("error", "Livre non trouvé"));
         response.add_header("Content-Type", "application/json; charset=utf-8");
-        addCorsHeaders(response);
         return std::move(response);
     }
 
@@ -316,130 +1032,113 @@ namespace crowjourney {
     crow::response updateBookTitle(const crow::request& req, int id) {
         auto& biblio = getBibliotheque();
         try {
-            auto body = json::parse(req.body);
+            LivreMaj body = analyserCorps(req.body, SCHEMA_TITRE);
 
             // Vérification que le titre est présent
-            if (!body.contains("titre")) {
-                json error = { {"error", "Le titre est obligatoire"} };
-                auto response = crow::response(400, error.dump());
+            if (!body.titre) {
+                auto response = crow::response(400, JsonWriter::objet("error", "Le titre est obligatoire"));
                 response.add_header("Content-Type", "application/json; charset=utf-8");
-                addCorsHeaders(response);
                 return std::move(response);
             }
 
-            std::string nouveauTitre = body["titre"].get<std::string>();
-
-            if (biblio.mettreAJourTitre(id, nouveauTitre)) {
-                Livre* livre = biblio.getLivreParId(id);
-                if (livre) {
-                    json result = biblio.livreToJson(*livre);
-                    result["message"] = "Titre mis à jour avec succès";
-                    auto response = crow::response(200, result.dump());
-                    response.add_header("Content-Type", "application/json; charset=utf-8");
-                    addCorsHeaders(response);
-                    return std::move(response);
-                }
+            auto livre = biblio.mettreAJourTitre(id, *body.titre, modeAcquittement(req));
+            if (livre) {
+                JsonWriter sortie;
+                sortie.debutObjet();
+                biblio.ecrireLivre(sortie, *livre);
+                sortie.champ("message", "Titre mis à jour avec succès").finObjet();
+                auto response = crow::response(200, sortie.prendre());
+                response.add_header("Content-Type", "application/json; charset=utf-8");
+                return std::move(response);
             }
-            json error = { {"error", "Livre non trouvé"} };
-            auto response = crow::response(404, error.dump());
+            auto response = crow::response(404, JsonWriter::objet("error", "Livre non trouvé"));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
+        catch (const ErreurJournal& e) {
+            return erreurJournal(e);
+        }
         catch (const std::exception& e) {
-            json error = { {"error", std::string("Erreur de format JSON: ") + e.what()} };
-            auto response = crow::response(400, error.dump());
+            auto response = crow::response(400, JsonWriter::objet("error", std::string("Erreur de format JSON: ") + e.what()));
             response.add_header("Content-Type", "application/json; charset=utf-8");
-            addCorsHeaders(response);
             return std::move(response);
         }
     }
 
-    // Gestionnaire pour les préflight OPTIONS (nécessaire pour CORS)(sans paramètres)
-    //crow::response handleOptions() {
-    //    auto response = crow::response(204);
-    //    response.add_header("Content-Type", "application/json; charset=utf-8");
-    //    addCorsHeaders(response);
-    //    return std::move(response);
-    //}
-
-    crow::response handleOptions() {
-        // Point d'arrêt ici ⬇️
-        std::cout << "handleOptions() called!" << std::endl << std::flush;
-
-        auto response = crow::response(204);
-        response.set_header("Content-Type", "application/json; charset=utf-8");
-
-        // Définir directement les en-têtes CORS au lieu d'utiliser la fonction additionnelle
-        response.set_header("Access-Control-Allow-Origin", "*");
-        response.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, PATCH, OPTIONS");
-        response.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-
-        // Vérifier que les en-têtes sont bien définis
-        std::cout << "CORS headers in OPTIONS: " << response.get_header_value("Access-Control-Allow-Origin") << std::endl << std::flush;
-
-        return response; // Essayer sans std::move()
-    }
-
-
-    // Gestionnaire pour les préflight OPTIONS (nécessaire pour CORS)(avec paramètre ID)
-    crow::response handleOptionsWithId(int id) {
-        auto response = crow::response(204);
-        response.add_header("Content-Type", "application/json; charset=utf-8");
-        addCorsHeaders(response);
-        return std::move(response);
-    }
-
-
     // Configuration des routes pour la bibliothèque - versions avec et sans authentification
-#if AUTH_ENABLED
-	void setup_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>& app) {
-#else
-	void setup_routes(crow::SimpleApp & app) {
-#endif
+    // (les préflights OPTIONS sont traités par CORSMiddleware, avant le routage ; la
+    // politique d'accès n'est appliquée qu'avec JWTAuthMiddleware)
+    void setup_routes(App& app) {
+        // GET /books - Récupérer tous les livres
+        ROUTE_ACCES(app, "/books", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(getAllBooks);
 
-        // Gestionnaire pour les préflight OPTIONS (nécessaire pour CORS)
-        CROW_ROUTE(app, "/books")
-            .methods(crow::HTTPMethod::OPTIONS)(handleOptions);
+        // GET /books/count - Comptage filtré, par décennie si demandé
+        ROUTE_ACCES(app, "/books/count", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(countBooks);
 
-        CROW_ROUTE(app, "/books/<int>")
-            .methods(crow::HTTPMethod::OPTIONS)(handleOptionsWithId);
+        // GET /books/stats - Statistiques du catalogue
+        ROUTE_ACCES(app, "/books/stats", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(getBookStats);
 
-        // GET /books - Récupérer tous les livres
-        CROW_ROUTE(app, "/books")
-            .methods(crow::HTTPMethod::GET)(getAllBooks);
+        // GET /books/search?q= - Recherche plein texte
+        ROUTE_ACCES(app, "/books/search", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(searchBooks);
+
+        // GET /books/suggest?prefix= - Autocomplétion des titres et auteurs
+        ROUTE_ACCES(app, "/books/suggest", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(suggestBooks);
 
         // POST /books - Ajouter un nouveau livre
-        CROW_ROUTE(app, "/books")
-            .methods(crow::HTTPMethod::POST)(addBook);
+        ROUTE_ACCES(app, "/books", crow::HTTPMethod::POST, ACCES_AUTHENTIFIE)(addBook);
 
         // GET /books/id - Récupérer un livre spécifique par ID
-        CROW_ROUTE(app, "/books/<int>")
-            .methods(crow::HTTPMethod::GET)(getBookById);
+        ROUTE_ACCES(app, "/books/<int>", crow::HTTPMethod::GET, ACCES_AUTHENTIFIE)(getBookById);
 
         // PUT /books/id - Mettre à jour un livre spécifique
-        CROW_ROUTE(app, "/books/<int>")
-            .methods(crow::HTTPMethod::PUT)(updateBook);
+        ROUTE_ACCES(app, "/books/<int>", crow::HTTPMethod::PUT, ACCES_AUTHENTIFIE)(updateBook);
 
         // DELETE /books/id - Supprimer un livre spécifique
-        CROW_ROUTE(app, "/books/<int>")
-            .methods(crow::HTTPMethod::Delete)(deleteBook);
+        ROUTE_ACCES(app, "/books/<int>", crow::HTTPMethod::Delete, ACCES_AUTHENTIFIE)(deleteBook);
 
         // PATCH /books/id/titre - Mettre à jour uniquement le titre d'un livre
-        CROW_ROUTE(app, "/books/<int>/titre")
-            .methods(crow::HTTPMethod::Patch)(updateBookTitle);
+        ROUTE_ACCES(app, "/books/<int>/titre", crow::HTTPMethod::Patch, ACCES_AUTHENTIFIE)(updateBookTitle);
 
     }
 
+    // GET /metrics - Compteurs et histogrammes au format Prometheus, pour le collecteur
+    // (public, comme d'habitude pour cette route : à filtrer au niveau du proxy)
+    // Corps de GET /metrics : séries du serveur, et avec l'authentification l'efficacité du
+    // cache des jetons vérifiés (aussi dans GET /auth/cache, en JSON)
+    static std::string exporterMetriques(App& app) {
+#if AUTH_ENABLED
+        const CacheJetons::Statistiques cache = app.get_middleware<JWTAuthMiddleware>().statistiquesCache();
+        return metriques::exporter({
+            { "crowjourney_jwt_cache_hits_total", "Jetons JWT trouvés dans le cache des jetons vérifiés", cache.succes },
+            { "crowjourney_jwt_cache_misses_total", "Jetons JWT absents du cache (ou expirés), vérifiés en entier", cache.echecs },
+            { "crowjourney_jwt_cache_evictions_total", "Entrées retirées du cache des jetons, segment plein", cache.evictions }
+        });
+#else
+        (void)app;
+        return metriques::exporter();
+#endif
+    }
+
+    void setup_metrics_routes(App& app) {
+        ROUTE_ACCES(app, "/metrics", crow::HTTPMethod::GET, ACCES_PUBLIC)([&app]() {
+            auto response = crow::response(200, exporterMetriques(app));
+            response.add_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+            response.add_header("Cache-Control", "no-store");
+            return std::move(response);
+            });
+    }
+
     // Initialisation de la bibliothèque
     void initialize() {
 #if AUTH_ENABLED
-        std::cout << "Initializing crowJourney library with authentication..." << std::endl;
+        TRACE_INFO("Initialisation de la bibliothèque", traces::champ("authentification", true));
 #else
-        std::cout << "Initializing crowJourney library WITHOUT authentication (development mode)..." << std::endl;
+        TRACE_INFO("Initialisation de la bibliothèque (mode développement)", traces::champ("authentification", false));
 #endif
 
-        // S'assurer que la bibliothèque est initialisée
-        auto& biblio = getBibliotheque();
+        // S'assurer que la bibliothèque et les utilisateurs sont chargés avant d'accepter
+        // des requêtes (un journal corrompu arrête le démarrage)
+        getBibliotheque();
+        initialiserUtilisateurs();
     }
     }
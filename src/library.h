@@ -6,26 +6,53 @@
 #include <crow.h>
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <cstdint>
+#include <thread>
+#include <shared_mutex>
+#include "SlotMap.h"
+#include "ChaineInternee.h"
+#include "IndexLivres.h"
+#include "RechercheTexte.h"
+#include "Suggestions.h"
+#include "ColonnesLivres.h"
+#include "StatistiquesLivres.h"
+#include "Journal.h"
+#include "JsonWriter.h"
+#include "CORSMiddleware.h"
+#include "PolitiquesAcces.h"
+#include "MetriquesMiddleware.h"
 
 // Vérifier si l'authentification est désactivée
 #ifndef DISABLE_AUTH
 #include "JWTAuthMiddleware.h"
 #include "CookieParser.h"
-#include "CORSMiddleware.h"
 #define AUTH_ENABLED 1
 #else
 #define AUTH_ENABLED 0
 #endif
 
 // Forward declarations
+// auteur et genre se répètent d'un livre à l'autre : ils sont internés
 struct Livre {
     std::string titre;
-    std::string auteur;
+    crowjourney::ChaineInternee auteur;
     int annee;
-    std::string genre;
+    crowjourney::ChaineInternee genre;
     int id;
 };
 
+// Champs d'une mise à jour partielle : seuls les champs présents dans la requête sont renseignés
+struct LivreMaj {
+    std::optional<std::string> titre;
+    std::optional<std::string> auteur;
+    std::optional<int> annee;
+    std::optional<std::string> genre;
+};
+
 // Utilisation de json comme alias pour nlohmann::json
 using json = nlohmann::json;
 
@@ -37,60 +64,177 @@ namespace nlohmann {
 
 namespace crowjourney {
 
+    // Version immuable du catalogue, partagée entre les threads de Crow.
+    // Une fois publiée, une instance n'est plus jamais modifiée ; les versions
+    // successives partagent les blocs de livres non modifiés.
+    struct CatalogueSnapshot {
+        SlotMap<Livre> livres; // Indexé par id, itéré dans l'ordre des ids
+        std::uint64_t version = 0;
+    };
+
+    // Corps JSON de GET /books pré-sérialisé pour une version donnée du catalogue
+    struct CorpsCatalogue {
+        std::uint64_t version = 0;
+        std::string corps;
+        std::string etag; // ETag fort : identifiant d'instance + version
+    };
+
+    // Corps JSON de GET /books/stats pré-sérialisé pour une version donnée du catalogue
+    struct CorpsStatistiques {
+        std::uint64_t version = 0;
+        std::size_t top = 0; // Nombre d'auteurs demandés dans top_auteurs
+        std::string corps;
+        std::string etag;
+    };
+
+    // Champs d'un livre sélectionnables par le paramètre fields de GET /books
+    enum ChampLivre : unsigned {
+        CHAMP_ID = 1u << 0,
+        CHAMP_TITRE = 1u << 1,
+        CHAMP_AUTEUR = 1u << 2,
+        CHAMP_ANNEE = 1u << 3,
+        CHAMP_GENRE = 1u << 4,
+        CHAMPS_TOUS = CHAMP_ID | CHAMP_TITRE | CHAMP_AUTEUR | CHAMP_ANNEE | CHAMP_GENRE
+    };
+
+    // Page de GET /books : livres d'id strictement supérieur à apres satisfaisant le filtre, au plus limite
+    struct RequetePage {
+        int apres = 0;
+        std::size_t limite = 100;
+        unsigned champs = CHAMPS_TOUS;
+        FiltreLivres filtre;
+    };
+
     // Classe principale pour la gestion de bibliothèque
+    // Les lecteurs récupèrent la version courante sans verrou ; les écrivains
+    // (sérialisés par ecriture_mutex_) construisent une nouvelle version puis la publient.
     class BibliothequeManager {
     private:
-        std::vector<Livre> livres_;
+        std::atomic<std::shared_ptr<const CatalogueSnapshot>> catalogue_;
+        std::mutex ecriture_mutex_;
+        mutable std::atomic<std::shared_ptr<const CorpsCatalogue>> corps_cache_;
+        std::string instance_; // Distingue les versions d'un processus à l'autre dans les ETag
+
+        // Index secondaires : modifiés avec la publication de chaque version sous verrou
+        // exclusif, lus sous verrou partagé avec la version correspondante
+        mutable std::shared_mutex index_mutex_;
+        IndexLivres index_;
+        RechercheTexte recherche_; // Index plein texte de GET /books/search
+        Suggestions suggestions_;  // Trie de GET /books/suggest
+        ColonnesLivres colonnes_;  // Copie en colonnes de GET /books/count
+        StatistiquesLivres statistiques_; // Compteurs de GET /books/stats
+        mutable std::atomic<std::shared_ptr<const CorpsStatistiques>> statistiques_cache_;
         int next_id_;
-        std::string filename_; // Fichier pour sauvegarder les livres
+        std::string filename_;          // Format JSON (import au démarrage à défaut d'instantané binaire)
+        std::string snapshot_filename_; // Instantané binaire projeté en mémoire au démarrage
+
+        // Chaque mutation est ajoutée au journal ; l'instantané n'est réécrit
+        // qu'à la compaction, en arrière-plan
+        Journal journal_;
+        std::thread compaction_;
+        std::size_t seuil_compaction_;
+
+        // Méthodes appelées avec ecriture_mutex_ verrouillé
+        void publier(std::shared_ptr<CatalogueSnapshot> suivant);
+        std::uint64_t valider(json enregistrement, std::shared_ptr<CatalogueSnapshot> suivant,
+            const Livre* avant, const Livre* apres);
+        void lancerCompaction();
+        void appliquer(CatalogueSnapshot& catalogue, const json& enregistrement);
+        bool ecrireInstantane(const CatalogueSnapshot& catalogue, std::uint64_t sequence, int prochain_id) const;
+        bool chargerInstantane(CatalogueSnapshot& catalogue, std::uint64_t& sequence);
+        bool importerJson(CatalogueSnapshot& catalogue, std::uint64_t& sequence);
+
+        // Appelé après avoir relâché ecriture_mutex_
+        void acquitter(std::uint64_t sequence, Acquittement mode);
 
     public:
         // Constructeur
-        BibliothequeManager(const std::string& filename = "books.json");
+        BibliothequeManager(const std::string& filename = "books.json", std::size_t seuil_compaction = 1000);
+        ~BibliothequeManager();
 
         // Méthodes de gestion de fichier
-        void saveBooks();
-        void loadBooks();
+        void loadBooks(); // Instantané puis relecture du journal
 
-        // Méthodes d'accès aux livres
-        const std::vector<Livre>& getTousLivres() const;
-        Livre* getLivreParId(int id);
+        // Méthodes d'accès aux livres (lecture sans verrou)
+        std::shared_ptr<const CatalogueSnapshot> getCatalogue() const;
+        std::optional<Livre> getLivreParId(int id) const;
 
-        // Méthodes de modification
-        Livre ajouterLivre(const std::string& titre, const std::string& auteur,
-            int annee = 0, const std::string& genre = "");
-        bool mettreAJourLivre(int id, const json& donnees);
-        bool supprimerLivre(int id);
-        bool mettreAJourTitre(int id, const std::string& nouveauTitre);
+        // Corps de GET /books pour la version courante, sérialisé une seule fois par version
+        std::shared_ptr<const CorpsCatalogue> getCorpsCatalogue() const;
+
+        // Écrire un tableau JSON des livres de la page ; renvoie l'id à passer en curseur
+        // pour la page suivante, 0 s'il n'y en a pas. Parcourt la version courante (ou,
+        // avec un filtre, l'index le plus sélectif) à partir du curseur sans copier le catalogue.
+        int ecrirePage(JsonWriter& sortie, const RequetePage& page) const;
+
+        // Écrire un tableau JSON des livres correspondant à la requête plein texte,
+        // par pertinence décroissante (BM25), avec leur score
+        void ecrireRecherche(JsonWriter& sortie, std::string_view requete, std::size_t limite) const;
+
+        // Corps de GET /books/stats pour la version courante ; celui du top par défaut
+        // n'est sérialisé qu'une fois par version
+        std::shared_ptr<const CorpsStatistiques> getCorpsStatistiques(std::size_t top) const;
 
-        // Méthode de conversion
-        json livreToJson(const Livre& livre) const;
+        // Écrire {"total": n} pour les livres satisfaisant le filtre, et si demandé
+        // "par_decennie": [{"decennie": 1940, "livres": n}, ...]
+        void ecrireComptage(JsonWriter& sortie, const FiltreLivres& filtre, bool par_decennie) const;
+
+        // Écrire un tableau JSON des titres et auteurs complétant la saisie
+        void ecrireSuggestions(JsonWriter& sortie, std::string_view saisie, std::size_t limite) const;
+
+        // Méthodes de modification (renvoient l'état publié du livre).
+        // En mode Durable, le retour attend la synchronisation du lot contenant la mutation.
+        Livre ajouterLivre(const std::string& titre, const std::string& auteur,
+            int annee = 0, const std::string& genre = "", Acquittement mode = Acquittement::Durable);
+        std::optional<Livre> mettreAJourLivre(int id, const LivreMaj& maj, Acquittement mode = Acquittement::Durable);
+        bool supprimerLivre(int id, Acquittement mode = Acquittement::Durable);
+        std::optional<Livre> mettreAJourTitre(int id, const std::string& nouveauTitre,
+            Acquittement mode = Acquittement::Durable);
+
+        // Écriture des champs d'un livre dans un objet JSON (sans construire de DOM)
+        void ecrireLivre(JsonWriter& sortie, const Livre& livre, unsigned champs = CHAMPS_TOUS) const;
     };
 
     // Fonction pour obtenir l'instance singleton du gestionnaire
     BibliothequeManager& getBibliotheque();
 
     // Déclarations des gestionnaires de requêtes API
-    crow::response getAllBooks();
+    crow::response getAllBooks(const crow::request& req);
+    crow::response countBooks(const crow::request& req);
+    crow::response getBookStats(const crow::request& req);
+    crow::response searchBooks(const crow::request& req);
+    crow::response suggestBooks(const crow::request& req);
     crow::response addBook(const crow::request& req);
     crow::response getBookById(int id);
     crow::response updateBook(const crow::request& req, int id);
-    crow::response deleteBook(int id);
+    crow::response deleteBook(const crow::request& req, int id);
     crow::response updateBookTitle(const crow::request& req, int id);
 
-    crow::response registerUser(const crow::request& req);
+    void registerUser(const crow::request& req, crow::response& res);
     crow::response getAllUsers();
+    crow::response changeUserRole(const crow::request& req, int id);
 
-    // Gestionnaire pour les préflight OPTIONS (nécessaire pour CORS)
-    crow::response handleOptions();
+    // Application Crow du serveur. Le routage vient en premier : les suivants lisent la
+    // route qu'il a reconnue. Puis les métriques, pour mesurer toute la requête, et CORS :
+    // les préflights sont traités avant l'authentification, et toute réponse repasse par lui.
+#if AUTH_ENABLED
+    using App = crow::App<RoutageMiddleware, MetriquesMiddleware, crowjourney_cors::CORSMiddleware, crow::CookieParser, JWTAuthMiddleware>;
+#else
+    using App = crow::App<RoutageMiddleware, MetriquesMiddleware, crowjourney_cors::CORSMiddleware>;
+#endif
 
-    // Configuration des routes avec support pour les deux modes
+    // Configuration des routes
+    void setup_routes(App& app);
+    void setup_user_routes(App& app);
+    void setup_metrics_routes(App& app);
 #if AUTH_ENABLED
-    void setup_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>& app);
+    void setup_auth_routes(App& app, JWTAuthMiddleware& jwtMiddleware);
 #else
-    void setup_routes(crow::SimpleApp& app);
+    void setup_auth_routes(App& app); // Sans paramètre jwtMiddleware
 #endif
 
-    // Initialisation de la bibliothèque
+    // Initialisation de la bibliothèque et des utilisateurs ; lève ErreurJournal si un
+    // journal est corrompu
     void initialize();
+    void initialiserUtilisateurs();
 }
@@ -1,66 +1,39 @@
-#include <iostream>
 #include <crow.h>
 #include "library.h"
-
-// Directive de préprocesseur pour choisir le mode (avec ou sans authentification)
-// Définissez cette macro dans les options de compilation pour activer le mode sans authentification
-// Par défaut, le mode avec authentification est utilisé
-#ifndef DISABLE_AUTH
-#define AUTH_ENABLED 1
-#else
-#include <crow/middlewares/cors.h> // Pour le CORS dans le mode sans auth
-#define AUTH_ENABLED 0
-#endif
-
-// Déclarations des fonctions avec les signatures correctes
-namespace crowjourney {
-    void initialize();
-
-#if AUTH_ENABLED
-    void setup_routes(crow::App<crow::CookieParser, crowjourney_cors::CORSMiddleware, crowjourney::JWTAuthMiddleware>& app);
-    void setup_user_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>& app);
-    void setup_auth_routes(crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware>& app, JWTAuthMiddleware& jwtMiddleware);
-    
-#else
-    void setup_routes(crow::SimpleApp& app);
-    void setup_user_routes(crow::SimpleApp& app);
-    void setup_auth_routes(crow::SimpleApp& app);  // Sans paramètre jwtMiddleware
-#endif
-
-    
-
+#include "Traces.h"
+
+// Le mode (avec ou sans authentification) est choisi par DISABLE_AUTH dans library.h,
+// qui définit aussi crowjourney::App avec les middlewares correspondants
+
+// Charger les données ; false (démarrage refusé) si un journal est illisible
+static bool initialiser() {
+    try {
+        crowjourney::initialize();
+        return true;
+    }
+    catch (const std::exception& e) {
+        TRACE_ERREUR("Démarrage impossible", crowjourney::traces::champ("erreur", e.what()));
+        crowjourney::traces::vider();
+        return false;
+    }
 }
 
 int main() {
 #if AUTH_ENABLED
-    std::cout << "Starting REST API server with authentication..." << std::endl;
-
-    // Créer une application Crow avec JWT middleware
-   // crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware> app;
-
-    crow::App<crow::CookieParser, crowjourney::JWTAuthMiddleware, crowjourney_cors::CORSMiddleware> app;
-
-    // Dans votre fonction main()
-// Ajouter juste après avoir créé l'application (pour tests)
-    CROW_ROUTE(app, "/test-options")
-        .methods(crow::HTTPMethod::OPTIONS)
-        ([](const crow::request& req) {
-        // Point d'arrêt ici ⬇️
-        std::cout << "Test OPTIONS route hit!" << std::endl << std::flush;
-        auto response = crow::response(204);
-        response.set_header("Access-Control-Allow-Origin", "*");
-        response.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-        response.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-        return response;
-            });
+    TRACE_INFO("Démarrage du serveur REST", crowjourney::traces::champ("authentification", true));
 
+    // Créer une application Crow avec les middlewares CORS et JWT
+    crowjourney::App app;
 
     // Initialiser la bibliothèque
-    crowjourney::initialize();
+    if (!initialiser()) {
+        return 1;
+    }
 
     // Configurer le middleware JWT avec une clé secrète plus sécurisée
     auto& jwtMiddleware = app.get_middleware<crowjourney::JWTAuthMiddleware>();
-    jwtMiddleware = crowjourney::JWTAuthMiddleware("votre_clé_secrète_très_longue_et_complexe", "crowjourney_api", 24);
+    // Le jeton est aussi accepté depuis le cookie HttpOnly posé par /login
+    jwtMiddleware = crowjourney::JWTAuthMiddleware("votre_clé_secrète_très_longue_et_complexe", "crowjourney_api", 24, "crowjourney_jeton");
 
     // Configurer les routes de la bibliothèque
     crowjourney::setup_routes(app);
@@ -71,9 +44,10 @@ int main() {
     // Configuration des routes d'authentification
     // Passer l'instance du middleware JWT
     crowjourney::setup_auth_routes(app, jwtMiddleware);
+    crowjourney::setup_metrics_routes(app);
 
-    // Ajouter d'autres routes protégées
-    CROW_ROUTE(app, "/protected")
+    // Ajouter d'autres routes protégées (refusées par le middleware sans jeton valide)
+    ROUTE_ACCES(app, "/protected", crow::HTTPMethod::GET, crowjourney::ACCES_AUTHENTIFIE)
         ([&](const crow::request& req) {
         // Vérifier si l'utilisateur est authentifié
         auto& ctx = app.get_context<crowjourney::JWTAuthMiddleware>(req);
@@ -96,11 +70,11 @@ int main() {
             });
 
     // Route admin protégée par rôle
-    CROW_ROUTE(app, "/admin")
+    ROUTE_ACCES(app, "/admin", crow::HTTPMethod::GET, crowjourney::ACCES_ADMIN)
         ([&](const crow::request& req) {
         auto& ctx = app.get_context<crowjourney::JWTAuthMiddleware>(req);
 
-        if (!ctx.authenticated || ctx.role != "admin") {
+        if (!crowjourney::JWTAuthMiddleware::hasRole(ctx, ROLE_ADMIN)) {
             crow::json::wvalue result;
             result["status"] = "error";
             result["message"] = "Accès réservé aux administrateurs";
@@ -116,26 +90,25 @@ int main() {
             });
 
     // Ajouter une route racine pour faciliter les tests
-    CROW_ROUTE(app, "/")
+    ROUTE_ACCES(app, "/", crow::HTTPMethod::GET, crowjourney::ACCES_PUBLIC)
         ([]() {
         return "Bienvenue sur l'API CrowJourney - API REST avec authentification JWT";
             });
 
     // Lancer le serveur sur le port 8080
-    std::cout << "Server starting on port 8080..." << std::endl;
+    TRACE_INFO("Écoute du serveur", crowjourney::traces::champ("port", 8080));
     //app.port(8080).multithreaded().run();
     app.port(8080).bindaddr("0.0.0.0").multithreaded().run();
 #else
-    std::cout << "Starting REST API server WITHOUT authentication (development mode)..." << std::endl;
+    TRACE_INFO("Démarrage du serveur REST (mode développement)", crowjourney::traces::champ("authentification", false));
 
-    // Créer une application Crow simple sans middleware JWT
-    crow::SimpleApp app;
+    // Créer une application Crow sans middleware JWT (CORS seulement)
+    crowjourney::App app;
 
     // Initialiser la bibliothèque
-    crowjourney::initialize();
-
-    // En mode sans authentification, nous n'ajoutons pas de middleware CORS
-    // mais nous ajoutons les en-têtes CORS à chaque réponse (c'est déjà fait dans vos fonctions)
+    if (!initialiser()) {
+        return 1;
+    }
 
     // Configurer les routes de la bibliothèque (sans authentification)
     crowjourney::setup_routes(app);
@@ -143,15 +116,16 @@ int main() {
     // Configurer les routes utilisateur et d'authentification
     crowjourney::setup_user_routes(app);
     crowjourney::setup_auth_routes(app); // Pas de paramètre jwtMiddleware en mode sans auth
+    crowjourney::setup_metrics_routes(app);
 
     // Ajouter une route racine pour faciliter les tests
-    CROW_ROUTE(app, "/")
+    ROUTE_ACCES(app, "/", crow::HTTPMethod::GET, crowjourney::ACCES_PUBLIC)
         ([]() {
         return "Bienvenue sur l'API CrowJourney - Version développement sans authentification";
             });
 
     // Lancer le serveur sur le port 8080
-    std::cout << "Server starting on port 8080 (development mode)..." << std::endl;
+    TRACE_INFO("Écoute du serveur (mode développement)", crowjourney::traces::champ("port", 8080));
     app.port(8080).bindaddr("0.0.0.0").multithreaded().run();
 #endif
 
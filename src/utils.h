@@ -1,37 +1,11 @@
 #pragma once
 #include <crow.h>
+#include "Journal.h"
 
 namespace crowjourney {
-    // Fonction utilitaire pour ajouter des headers CORS à une réponse
-
-#ifdef DISABLE_AUTH
-    inline void addCorsHeaders(crow::response& res) {
-        // Mode sans authentification - ajout des en-têtes CORS
-        res.add_header("Access-Control-Allow-Origin", "*");
-        res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, PATCH, OPTIONS");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-        std::cout << "En-têtes CORS ajoutés à la réponse" << std::endl;
+    // Mode d'acquittement demandé par le client via l'en-tête X-Ack-Mode
+    // ("immediate" : réponse sans attendre le disque ; par défaut : après synchronisation)
+    inline Acquittement modeAcquittement(const crow::request& req) {
+        return req.get_header_value("X-Ack-Mode") == "immediate" ? Acquittement::Immediat : Acquittement::Durable;
     }
 }
-#else
-        // Mode avec authentification - ajout des entetes CORS 
-    inline void addCorsHeaders(crow::response& res) {
-        // Vérifier si les en-têtes existent déjà
-        std::cout << "Valeur actuelle de Access-Control-Allow-Origin: '"
-            << res.get_header_value("Access-Control-Allow-Origin") << "'" << std::endl;
-
-        // Supprimer les en-têtes existants pour éviter les conflits
-        res.headers.erase("Access-Control-Allow-Origin");
-        res.headers.erase("Access-Control-Allow-Methods");
-        res.headers.erase("Access-Control-Allow-Headers");
-
-        // Ajouter les en-têtes CORS
-        res.add_header("Access-Control-Allow-Origin", "*");
-        res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, PATCH, OPTIONS");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-
-        std::cout << "En-têtes CORS ajoutés à la réponse (après nettoyage)" << std::endl;
-    }
-#endif
-
-}